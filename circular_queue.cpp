@@ -2,13 +2,18 @@
 #include <string>
 #include <ctime>
 #include <iomanip>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 #include "circular_queue.h"
+#include "system_log.h"
+#include "metrics.h"
 
 using namespace std;
 
 CircularQueue* createQueue(int capacity) {
     if (capacity <= 0) {
-        cout << "错误：队列容量必须大于0" << endl;
+        logEvent(LOG_ERROR, "queue", "invalid capacity %d", capacity);
         return nullptr;
     }
     
@@ -21,7 +26,7 @@ CircularQueue* createQueue(int capacity) {
     queue->size = 0;
     queue->capacity = capacity;
     
-    cout << "循环队列创建成功，容量：" << capacity << endl;
+    logEvent(LOG_DEBUG, "queue", "created capacity=%d", capacity);
     return queue;
 }
 
@@ -34,7 +39,7 @@ void destroyQueue(CircularQueue* queue) {
     
     delete queue;
     
-    cout << "队列已销毁" << endl;
+    logEvent(LOG_DEBUG, "queue", "destroyed");
 }
 
 bool isQueueEmpty(CircularQueue* queue) {
@@ -53,13 +58,14 @@ int getQueueSize(CircularQueue* queue) {
 }
 
 bool enqueue(CircularQueue* queue, InOrder order) {
+    MetricTimer timer(METRIC_ENQUEUE);
     if (queue == nullptr) {
         cout << "错误：队列不存在" << endl;
         return false;
     }
     
     if (isQueueFull(queue)) {
-        cout << "错误：队列已满，无法添加新订单" << endl;
+        logEvent(LOG_WARN, "queue", "full, order for med_id=%d rejected", order.med_id);
         return false;
     }
     
@@ -69,11 +75,12 @@ bool enqueue(CircularQueue* queue, InOrder order) {
     
     queue->size++;
     
-    cout << "订单入队成功，当前队列大小：" << queue->size << endl;
+    logEvent(LOG_DEBUG, "queue", "enqueue med_id=%d size=%d", order.med_id, queue->size);
     return true;
 }
 
 bool dequeue(CircularQueue* queue, InOrder* order) {
+    MetricTimer timer(METRIC_DEQUEUE);
     if (queue == nullptr || order == nullptr) {
         cout << "错误：参数无效" << endl;
         return false;
@@ -90,10 +97,28 @@ bool dequeue(CircularQueue* queue, InOrder* order) {
     
     queue->size--;
     
-    cout << "订单出队成功，当前队列大小：" << queue->size << endl;
+    logEvent(LOG_DEBUG, "queue", "dequeue med_id=%d size=%d", order->med_id, queue->size);
     return true;
 }
 
+int dequeueBatch(CircularQueue* queue, InOrder* orders, int max_count) {
+    if (queue == nullptr || orders == nullptr || max_count <= 0) {
+        return 0;
+    }
+    
+    // 环形缓冲最多分两段，整块拷贝，不逐条输出
+    int n = min(max_count, queue->size);
+    int first = min(n, queue->capacity - queue->front);
+    memcpy(orders, &queue->orders[queue->front], sizeof(InOrder) * first);
+    memcpy(orders + first, queue->orders, sizeof(InOrder) * (n - first));
+    
+    queue->front = (queue->front + n) % queue->capacity;
+    
+    queue->size -= n;
+    
+    return n;
+}
+
 bool addInOrder(CircularQueue* queue, int med_id, int quantity, const string& operator_name) {
     if (queue == nullptr) {
         cout << "错误：队列不存在" << endl;
@@ -151,43 +176,58 @@ int processInOrder(CircularQueue* queue, OrderedList* inventory) {
         return 0;
     }
     
-    cout << "\n========== 开始处理入库单 ==========" << endl;
-    cout << "待处理数量：" << queue->size << endl;
+    // 整队取出，按药品ID排序后合并同一药品的入库量
+    vector<InOrder> orders(queue->size);
+    int order_count = dequeueBatch(queue, orders.data(), queue->size);
     
-    int processed_count = 0;
-    InOrder current_order;
+    vector<pair<int, int>> items(order_count);  // (药品ID, 数量)
+    for (int k = 0; k < order_count; k++) {
+        items[k] = make_pair(orders[k].med_id, orders[k].quantity);
+    }
+    sort(items.begin(), items.end());
     
-    while (dequeue(queue, &current_order)) {
-        processed_count++;
+    // 与按ID有序的库存表归并遍历，每种药品只更新一次库存和预警状态
+    int processed_count = 0;
+    int medicine_count = 0;
+    int recovered_count = 0;
+    long long total_quantity = 0;
+    int i = 0;
+    for (int k = 0; k < order_count; ) {
+        int med_id = items[k].first;
+        int count = 0;
+        int quantity = 0;
+        for (; k < order_count && items[k].first == med_id; k++) {
+            quantity += items[k].second;
+            count++;
+        }
         
-        Medicine* medicine = findMedicine(inventory, current_order.med_id);
+        while (i < inventory->length && inventory->medicines[i].id < med_id) i++;
+        if (i == inventory->length || inventory->medicines[i].id != med_id) {
+            continue;
+        }
         
-        if (medicine != nullptr) {
-            medicine->stock += current_order.quantity;
-            
-            cout << "\n[处理入库单 " << processed_count << "]" << endl;
-            cout << "药品：" << medicine->name << " (ID: " << current_order.med_id << ")" << endl;
-            cout << "入库数量：" << current_order.quantity << endl;
-            cout << "原库存：" << medicine->stock - current_order.quantity << endl;
-            cout << "新库存：" << medicine->stock << endl;
-            cout << "操作员：" << current_order.operator_name << endl;
-            
-            char time_str[20];
-            tm* timeinfo = localtime(&current_order.in_time);
-            strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
-            cout << "入库时间：" << time_str << endl;
-            
-            if (medicine->is_warning && medicine->stock >= medicine->warning_threshold) {
-                cout << "注意：库存已恢复，预警解除！" << endl;
-                medicine->is_warning = false;
-            }
-        } else {
-            cout << "警告：药品ID " << current_order.med_id << " 不存在，跳过此订单" << endl;
+        Medicine* medicine = &inventory->medicines[i];
+        medicine->stock += quantity;
+        if (medicine->is_warning && medicine->stock >= medicine->warning_threshold) {
+            medicine->is_warning = false;
+            recovered_count++;
         }
+        processed_count += count;
+        medicine_count++;
+        total_quantity += quantity;
     }
     
-    cout << "\n========== 处理完成 ==========" << endl;
-    cout << "共处理入库单：" << processed_count << " 个" << endl;
+    cout << "\n========== 入库单处理完成 ==========" << endl;
+    cout << "共处理入库单：" << processed_count << " 个，涉及药品 " << medicine_count
+         << " 种，入库总量 " << total_quantity << endl;
+    if (recovered_count > 0) {
+        cout << "库存恢复、预警解除：" << recovered_count << " 种" << endl;
+    }
+    if (processed_count < order_count) {
+        cout << "警告：" << order_count - processed_count << " 个入库单的药品不存在，已跳过" << endl;
+    }
+    logEvent(LOG_INFO, "inbound", "processed orders=%d medicines=%d quantity=%lld unknown=%d",
+             processed_count, medicine_count, total_quantity, order_count - processed_count);
     
     return processed_count;
 }
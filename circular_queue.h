@@ -2,6 +2,8 @@
 #ifndef _CIRCULAR_QUEUE_H
 #define _CIRCULAR_QUEUE_H
 
+#include <mutex>
+#include <vector>
 #include "medicine.h"
 
 // ѭнṹ
@@ -11,6 +13,7 @@ typedef struct {
     int rear;                   // βָ
     int capacity;               // 
     int size;                   // ǰС
+    std::mutex lock;            // Ǽ߳ȡ⣨enqueue/dequeue
 } CircularQueue;
 
 // ʼ
@@ -20,13 +23,15 @@ void destroyQueue(CircularQueue *queue);
 // 
 int enqueue(CircularQueue *queue, InOrder order);    // 
 int dequeue(CircularQueue *queue, InOrder *order);   // 
+int dequeueBatch(CircularQueue *queue, InOrder *orders, int max_count); // ӣ
+int takeAllInOrders(CircularQueue *queue, std::vector<InOrder>& orders); // ȡ
 int isQueueEmpty(CircularQueue *queue);              // п
 int isQueueFull(CircularQueue *queue);               // 
 int getQueueSize(CircularQueue *queue);              // ȡС
 
 // ҵ
 int addInOrder(CircularQueue *queue, int med_id, int quantity, const char *operator);
-int processInOrder(CircularQueue *queue, OrderedList *inventory); // ⵥ¿棩
+int processInOrder(CircularQueue *queue, OrderedList *inventory); // ⵥȡҩƷϲ¿棬ֻܣ
 void displayInOrders(CircularQueue *queue);          // ʾⵥ
 
 // ̨
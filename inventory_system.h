@@ -6,12 +6,17 @@
 #include "circular_queue.h"
 #include "linked_stack.h"
 #include "statistics.h"
+#include "journal.h"
+#include "system_log.h"
 
 // ϵͳṹ
+// inventoryĿɶշն̲߳ãordered_list.h
+// inQueueoutStackjournalֻɲ˵̷߳ʣջն˸
 typedef struct {
     OrderedList *inventory;     // 
     CircularQueue *inQueue;     // 
     LinkedStack *outStack;      // ջ
+    Journal *journal;           // ˮ־
     DailyStats today_stats;     // ͳ
     char current_date[11];      // ǰ
 } InventorySystem;
@@ -39,9 +44,72 @@ void statisticsMenu(InventorySystem *system);
 void monitorWarnings(InventorySystem *system);  // ʵʱԤ
 void displayWarningList(InventorySystem *system); // ʾԤб
 
-// ϵͳ
-void backupData(InventorySystem *system);       // ݱ
-void restoreData(InventorySystem *system);      // ݻָ
-void systemLog(const char *message);            // ϵͳ־
+// Ǽǣ˵طŹãɶ̲߳ãԤѯڵ߳нУ
+// whenΪҵʱ䣬0ʾǰʱ䣩
+int receiveMedicine(OrderedList *inventory, CircularQueue *inQueue, Journal *journal,
+                    int med_id, int quantity, const char *operator_name, bool *queued, time_t when = 0);
+int dispenseMedicine(OrderedList *inventory, LinkedStack *outStack, Journal *journal,
+                     int med_id, int quantity, const char *prescription_no, time_t when = 0);
+
+// ģʽtest02 --batch [ļ]ִ add/in/out/process/stock/warnings/report/save/quit
+// ÿһJSONУʧܵ
+int runBatchMode(const char *filename, OrderedList *inventory, CircularQueue *inQueue,
+                 LinkedStack *outStack, Journal *journal);
+
+// HTTP/JSONӿڣtest02 --serve [˿]ֻ127.0.0.1system.htmlã
+// HostΪ127.0.0.1localhostӶ˿ڣ޸ݵX-Requested-WithͷOriginͬԴ403
+// ޸Ŀڱˮ̺ӦύCtrl+Cֹͣʱˮ
+// GET  /                              system.html
+// GET  /api/medicines[/{id}]          ҩƷб/ҩƷ7վ
+// POST /api/medicines                 PUT|DELETE /api/medicines/{id} ޸/ɾ
+// POST /api/in, /api/out              ⣨med_id,quantity,operator_name/⣨med_id,quantity,prescription_no
+// POST /api/in/process                ⵥ
+// GET  /api/warnings                  ԤҩƷPOST /api/thresholds/refresh ֵ
+// GET  /api/reports/daily?date=       ձջջܣ
+// GET  /api/reports/ranking?days=&top=&by=quantity|frequency
+// GET  /api/ledger?date=              ̨ˣǰսࡢ⡢⡢սࣻȡ԰ͳͼ
+int runHttpServer(int port, OrderedList *inventory, CircularQueue *inQueue, LinkedStack *outStack,
+                  Journal *journal);
+
+// ׼׼test02 --bench [ļ] [--full]ܲԲ˵4ZYĺϳ
+// ɾ顢СջȫͳƱĬϹģҩƷ100~10򡢳ʷ1ǧ~100
+// --fullչ100/1000ÿ/Ρp50/p99ʹ/룬дJSONĬbench_results.json
+int runBenchSuite(const char *filename, bool full);
+
+// ϳ
+typedef struct {
+    unsigned int seed;          // 
+    int days;                   // ģ죩
+    int prescriptions_per_day;  // ƽմ
+    int medicines;              // ҩƷ
+} WorkloadConfig;
+
+// ϳطţtest02 --workload [] [] [ƽմ] [ҩƷ]ܲԲ˵5
+// ⵥ/ⵥ¼Zipfȶȡ뼾߷塢ֵ
+// Ǽ/ⵥ/+Ԥȫٻطţ¼/롢¼p50/p99ӳٺͷֵڴ棻
+// ͬһɵ¼ȫͬطźĩӦһ
+int runWorkload(const WorkloadConfig& config);
+
+// ʷֲ㣺ڴеĳջֻHISTORY_HOT_DAYS죨Ĭ30죩ĳⵥʱ
+// ͿʱsealExpiredΪֶֻļhistory_<>_<ֹ>_<>.seg嵥Ϊhistory.idx
+// ֶΰдҩƷID䳤ţͬźϲǰ׺ÿոҩƷܣ
+// жͳֻͻУļڴӳ䰴ȡһʷԼMB
+// еУ飬״ζȡĳʱУ飬𻵵мǴ־ȡ嵥гֹżһ
+// طˮ־ʱѷڵĳⵥڴ档ӦLinkedStackĳԱ
+//   int openArchive(const char *manifest, int keep_days);  ù鵵嵥
+//   int sealExpired(DayId today);                          ڱڵĳⵥ-1ʧ
+//   getDaySegment/getDailyOrders                           鵵͸ȡֶļ
+
+// ͳͼOrderedList::dailyǼʱۼⵥԤʱ
+// ۼӦʱͼձΪmedicines.dat.dailyʱֻ֮ˮ
+// طʱˮķʱԤʱʵһ¡ձĳⲿֶջշֶΣջͬۼ
+// ߶ʷgetDailyStats/getAvgResponseTimeֱӶȡⵥΪյǼǵȫ
+// ⵥⵥǷѴӰ죻ƽӦʱΪָڽԤƽʱ
+
+// ϵͳߣڿ + ˮ־
+void backupData(InventorySystem *system);       // ݱݣύ־ղ־
+void restoreData(InventorySystem *system);      // ݻָ뱸ݿղطű־
+void systemLog(const char *message);            // ϵͳ־һINFOsystem_log.h
+void metricsMenu();                             // ϵͳָ꣨metrics.h
 
 #endif
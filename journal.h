@@ -0,0 +1,61 @@
+//ӿڰ ˮ־ 
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include <stdio.h>
+#include <mutex>
+#include "ordered_list.h"
+#include "circular_queue.h"
+#include "linked_stack.h"
+
+#define JOURNAL_FILE "stock.journal"
+#define JOURNAL_BATCH_SIZE 64       // ܹôδ̼¼ʱǿύ
+#define JOURNAL_IN  1               // 
+#define JOURNAL_OUT 2               // 
+
+// ˮ¼׷д룩
+typedef struct {
+    unsigned int seq;           // ˮţ
+    int type;                   // JOURNAL_IN / JOURNAL_OUT
+    int med_id;                 // ҩƷ
+    int quantity;               // 
+    time_t event_time;          // ʱ
+    char date[11];              // 
+    char ref[30];               // ΪԱΪ
+    unsigned int checksum;      // ֶεУ
+} JournalRecord;
+
+// ˮ־
+typedef struct {
+    FILE *fp;                   // ׷ӷʽ򿪵־ļ
+    unsigned int next_seq;      // һ¼
+    int pending;                // д뵫δ̵ļ¼
+    int batch_size;             // ύС
+    std::mutex lock;            // ̲߳׷ӡύ
+} Journal;
+
+// ر
+Journal* openJournal(const char *filename, unsigned int next_seq, int batch_size);
+void closeJournal(Journal *journal);
+
+// д루ɶ̲߳ãύһύȫδ̼¼
+// дʧʱ¼˳̵ļ¼ָܻһµĿ
+int appendJournal(Journal *journal, int type, int med_id,
+                  int quantity, const char *ref, const char *date, time_t event_time);
+int commitJournal(Journal *journal);
+
+// 㣺ύˮһˮΪűգб涼
+// ʱcheckpointCatalogueѹ־
+int saveCheckpoint(OrderedList *inventory, Journal *journal, const char *filename);
+
+// ѹռֻ֮δ鵵ڵĳ¼ضļ¼-1ʧ
+int compactJournal(Journal *journal, const char *filename, LinkedStack *outStack);
+
+// ҩƷĿ¼ɾġ룩дˮգ-1ʧܣд־
+int saveCatalogueChange(OrderedList *inventory, Journal *journal, LinkedStack *outStack, const char *what);
+
+// ʱڿջطţûжӦҩƷļ¼д־һЧ¼
+unsigned int replayJournal(const char *filename, OrderedList *inventory,
+                           CircularQueue *inQueue, LinkedStack *outStack);
+
+#endif
@@ -4,17 +4,19 @@
 #include <sstream>
 #include <cstring>
 #include "linked_stack.h"
+#include "system_log.h"
+#include "metrics.h"
 
 using namespace std;
 
 // ==================== 构造函数和析构函数 ====================
 LinkedStack::LinkedStack() : top(nullptr), size(0) {
-    cout << "链栈初始化成功" << endl;
+    logEvent(LOG_DEBUG, "stack", "created");
 }
 
 LinkedStack::~LinkedStack() {
     clear();
-    cout << "链栈已销毁" << endl;
+    logEvent(LOG_DEBUG, "stack", "destroyed");
 }
 
 // ==================== 基本栈操作 ====================
@@ -28,8 +30,25 @@ int LinkedStack::getSize() const {
 
 // ==================== 栈的核心操作 ====================
 void LinkedStack::push(const OutOrderNode& order) {
-    // 创建新节点
-    OutOrderNode* new_node = new OutOrderNode(order);
+    MetricTimer timer(METRIC_STACK_PUSH);
+    // 从节点池取节点，字符串存入驻留区
+    StackNode* new_node = nodes.allocate();
+    new_node->med_id = order.med_id;
+    new_node->med_name = strings.intern(order.med_name);
+    new_node->quantity = order.quantity;
+    new_node->prescription_no = strings.intern(order.prescription_no);
+    new_node->patient_name = strings.intern(order.patient_name);
+    new_node->out_time = order.out_time;
+    new_node->day = timeToDayId(order.out_time);
+    
+    // 计入当日汇总
+    DaySegment& segment = days[new_node->day];
+    segment.prescription_count++;
+    segment.total_quantity += new_node->quantity;
+    MedDayTotal& med = segment.meds[new_node->med_id];
+    med.med_name = new_node->med_name;
+    med.quantity += new_node->quantity;
+    med.count++;
     
     // 新节点指向原栈顶
     new_node->next = top;
@@ -40,36 +59,42 @@ void LinkedStack::push(const OutOrderNode& order) {
     // 栈大小增加
     size++;
     
-    cout << "出库单入栈成功，当前栈大小: " << size << endl;
+    logEvent(LOG_DEBUG, "stack", "push med_id=%d size=%d", order.med_id, size);
 }
 
 bool LinkedStack::pop(OutOrderNode& order) {
+    MetricTimer timer(METRIC_STACK_POP);
     if (isEmpty()) {
         cout << "提示：栈为空，无法出栈" << endl;
         return false;
     }
     
     // 获取栈顶节点
-    OutOrderNode* temp = top;
+    StackNode* temp = top;
     
     // 复制数据
-    order.med_id = temp->med_id;
-    order.med_name = temp->med_name;
-    order.quantity = temp->quantity;
-    order.prescription_no = temp->prescription_no;
-    order.patient_name = temp->patient_name;
-    order.out_time = temp->out_time;
+    toOrder(temp, order);
     
     // 更新栈顶指针
     top = top->next;
     
-    // 删除原栈顶节点
-    delete temp;
+    // 从当日汇总中扣除
+    auto it = days.find(temp->day);
+    DaySegment& segment = it->second;
+    segment.prescription_count--;
+    segment.total_quantity -= temp->quantity;
+    MedDayTotal& med = segment.meds[temp->med_id];
+    med.quantity -= temp->quantity;
+    if (--med.count == 0) segment.meds.erase(temp->med_id);
+    if (segment.prescription_count == 0) days.erase(it);
+    
+    // 节点归还节点池（驻留的字符串随栈清空统一释放）
+    nodes.release(temp);
     
     // 栈大小减少
     size--;
     
-    cout << "出库单出栈成功，当前栈大小: " << size << endl;
+    logEvent(LOG_DEBUG, "stack", "pop med_id=%d size=%d", order.med_id, size);
     return true;
 }
 
@@ -78,12 +103,7 @@ bool LinkedStack::peek(OutOrderNode& order) const {
         return false;
     }
     
-    order.med_id = top->med_id;
-    order.med_name = top->med_name;
-    order.quantity = top->quantity;
-    order.prescription_no = top->prescription_no;
-    order.patient_name = top->patient_name;
-    order.out_time = top->out_time;
+    toOrder(top, order);
     
     return true;
 }
@@ -155,7 +175,7 @@ void LinkedStack::displayAllOutOrders() const {
     cout << "说明：栈顶是最新的出库单" << endl;
     cout << "------------------------------------" << endl;
     
-    OutOrderNode* current = top;
+    StackNode* current = top;
     int count = 1;
     
     while (current != nullptr) {
@@ -176,60 +196,72 @@ void LinkedStack::displayAllOutOrders() const {
 
 // ==================== 出库统计 ====================
 int LinkedStack::getTodayOutTotal(const std::string& date) const {
-    int total = 0;
-    OutOrderNode* current = top;
-    
-    while (current != nullptr) {
-        // 检查日期是否匹配
-        string order_date = timeToString(current->out_time).substr(0, 10);
-        if (order_date == date) {
-            total += current->quantity;
-        }
-        current = current->next;
-    }
-    
-    return total;
+    return getTodayOutTotal(dateToDayId(date));
 }
 
 int LinkedStack::getMedOutTotal(int med_id, const std::string& date) const {
-    int total = 0;
-    OutOrderNode* current = top;
-    
-    while (current != nullptr) {
-        string order_date = timeToString(current->out_time).substr(0, 10);
-        if (current->med_id == med_id && order_date == date) {
-            total += current->quantity;
-        }
-        current = current->next;
-    }
-    
-    return total;
+    return getMedOutTotal(med_id, dateToDayId(date));
 }
 
 int LinkedStack::getPrescriptionCount(const std::string& date) const {
-    int count = 0;
-    OutOrderNode* current = top;
-    
-    while (current != nullptr) {
-        string order_date = timeToString(current->out_time).substr(0, 10);
-        if (order_date == date) {
-            count++;
-        }
-        current = current->next;
-    }
-    
-    return count;
+    return getPrescriptionCount(dateToDayId(date));
+}
+
+const DaySegment* LinkedStack::getDaySegment(DayId day) const {
+    auto it = days.find(day);
+    return it == days.end() ? nullptr : &it->second;
+}
+
+int LinkedStack::getTodayOutTotal(DayId day) const {
+    const DaySegment* segment = getDaySegment(day);
+    return segment == nullptr ? 0 : segment->total_quantity;
+}
+
+int LinkedStack::getMedOutTotal(int med_id, DayId day) const {
+    const DaySegment* segment = getDaySegment(day);
+    if (segment == nullptr) return 0;
+    auto it = segment->meds.find(med_id);
+    return it == segment->meds.end() ? 0 : it->second.quantity;
+}
+
+int LinkedStack::getPrescriptionCount(DayId day) const {
+    const DaySegment* segment = getDaySegment(day);
+    return segment == nullptr ? 0 : segment->prescription_count;
 }
 
 // ==================== 遍历栈 ====================
 void LinkedStack::traverse(void (*visit)(OutOrderNode*)) const {
-    OutOrderNode* current = top;
+    StackNode* current = top;
+    OutOrderNode order;
     while (current != nullptr) {
-        visit(current);
+        toOrder(current, order);
+        visit(&order);
         current = current->next;
     }
 }
 
+// ==================== 日序号换算 ====================
+static DayId civilToDayId(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+DayId dateToDayId(const std::string& date) {
+    int y = 0, m = 0, d = 0;
+    if (sscanf(date.c_str(), "%d-%d-%d", &y, &m, &d) != 3) return -1;
+    return civilToDayId(y, m, d);
+}
+
+DayId timeToDayId(time_t t) {
+    // 按固定的UTC+8划分日期，不受主机时区设置影响；向下取整，1970年以前也正确
+    long long local = (long long)t + DAY_UTC_OFFSET;
+    return (DayId)(local >= 0 ? local / 86400 : (local - 86399) / 86400);
+}
+
 // ==================== 私有辅助函数 ====================
 std::string LinkedStack::timeToString(time_t t) const {
     char buffer[20];
@@ -238,11 +270,58 @@ std::string LinkedStack::timeToString(time_t t) const {
     return string(buffer);
 }
 
+void LinkedStack::toOrder(const StackNode* node, OutOrderNode& order) const {
+    order.med_id = node->med_id;
+    order.med_name = node->med_name;
+    order.quantity = node->quantity;
+    order.prescription_no = node->prescription_no;
+    order.patient_name = node->patient_name;
+    order.out_time = node->out_time;
+    order.day = node->day;
+    order.next = nullptr;
+}
+
 void LinkedStack::clear() {
-    while (!isEmpty()) {
-        OutOrderNode* temp = top;
-        top = top->next;
-        delete temp;
-        size--;
+    // 整块释放节点和字符串，代价与块数成正比
+    nodes.reset();
+    strings.clear();
+    days.clear();
+    top = nullptr;
+    size = 0;
+}
+
+// ==================== 字符串驻留区 ====================
+const char* StringArena::intern(const std::string& str) {
+    auto it = pool.find(std::string_view(str));
+    if (it != pool.end()) {
+        return it->data();
+    }
+    
+    size_t need = str.size() + 1;
+    char* dest;
+    if (need > BLOCK_SIZE) {
+        // 超长字符串单独占一块，不影响当前块的剩余空间
+        dest = new char[need];
+        blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), dest);
+    } else {
+        if (block_used + need > BLOCK_SIZE) {
+            blocks.push_back(new char[BLOCK_SIZE]);
+            block_used = 0;
+        }
+        dest = blocks.back() + block_used;
+        block_used += need;
+    }
+    
+    memcpy(dest, str.c_str(), need);
+    pool.insert(std::string_view(dest, str.size()));
+    return dest;
+}
+
+void StringArena::clear() {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        delete[] blocks[i];
     }
+    blocks.clear();
+    pool.clear();
+    block_used = BLOCK_SIZE;
 }
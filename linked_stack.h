@@ -3,8 +3,21 @@
 #define LINKED_STACK_H
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
 #include <ctime>
 
+// 日序号：1970-01-01为0。入栈时由出库时间换算一次（按固定时区UTC+8），之后按日过滤只比较整数
+typedef int DayId;
+
+#define DAY_UTC_OFFSET (8 * 3600)               // 划分日期所用的固定时区偏移（秒）
+
+DayId dateToDayId(const std::string& date);    // "YYYY-MM-DD" -> 日序号，纯整数运算
+DayId timeToDayId(time_t t);                   // 时间 -> 所在UTC+8日期的日序号，与主机时区无关
+
 // 出库单节点结构（链栈节点）
 struct OutOrderNode {
     int med_id;                 // 药品编号
@@ -13,6 +26,7 @@ struct OutOrderNode {
     std::string prescription_no;// 处方号（题目要求：配发处方）
     std::string patient_name;   // 患者姓名
     time_t out_time;            // 出库时间
+    DayId day;                  // 出库日序号
     
     // 指针域
     OutOrderNode* next;         // 指向下一个节点的指针
@@ -23,14 +37,105 @@ struct OutOrderNode {
         : med_id(id), med_name(name), quantity(qty), 
           prescription_no(pres_no), patient_name(patient), next(nullptr) {
         out_time = time(nullptr);
+        day = timeToDayId(out_time);
+    }
+};
+
+// 栈内部节点：字符串指向驻留区，节点本身来自节点池，入栈不做堆分配
+struct StackNode {
+    int med_id;                 // 药品编号
+    const char* med_name;       // 药品名称（驻留）
+    int quantity;               // 出库数量
+    const char* prescription_no;// 处方号（驻留）
+    const char* patient_name;   // 患者姓名（驻留）
+    time_t out_time;            // 出库时间
+    DayId day;                  // 出库日序号
+    StackNode* next;            // 指向下一个节点的指针
+};
+
+// 单个药品某日的出库汇总
+struct MedDayTotal {
+    const char* med_name;       // 药品名称（驻留）
+    int quantity;               // 出库总量
+    int count;                  // 出库单数
+    MedDayTotal() : med_name(""), quantity(0), count(0) {}
+};
+
+// 按日汇总的出库记录，入栈/出栈时同步维护，按日统计不再遍历栈
+struct DaySegment {
+    int prescription_count;                     // 当日出库单数
+    int total_quantity;                         // 当日出库总量
+    std::unordered_map<int, MedDayTotal> meds;  // 药品ID -> 当日汇总
+    DaySegment() : prescription_count(0), total_quantity(0) {}
+};
+
+// 字符串驻留区：相同内容只存一份，按块分配，整体释放
+class StringArena {
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<char*> blocks;                  // 已分配的块
+    size_t block_used;                          // 最后一块已用字节数
+    std::unordered_set<std::string_view> pool;  // 已驻留的字符串
+    
+public:
+    StringArena() : block_used(BLOCK_SIZE) {}
+    ~StringArena() { clear(); }
+    
+    const char* intern(const std::string& str);
+    void clear();
+};
+
+// 节点池：按块批量分配节点，出栈的节点挂到空闲链表上复用，清空时整块释放
+template <typename Node>
+class NodePool {
+private:
+    static const int CHUNK_SIZE = 512;  // 每块节点数
+    std::vector<Node*> chunks;          // 已分配的块
+    int chunk_used;                     // 最后一块已用节点数
+    Node* free_list;                    // 回收节点链表（借用next指针）
+    
+public:
+    NodePool() : chunk_used(CHUNK_SIZE), free_list(nullptr) {}
+    ~NodePool() { reset(); }
+    
+    Node* allocate() {
+        if (free_list != nullptr) {
+            Node* node = free_list;
+            free_list = free_list->next;
+            return node;
+        }
+        if (chunk_used == CHUNK_SIZE) {
+            chunks.push_back(static_cast<Node*>(::operator new(sizeof(Node) * CHUNK_SIZE)));
+            chunk_used = 0;
+        }
+        return &chunks.back()[chunk_used++];
+    }
+    
+    void release(Node* node) {
+        node->next = free_list;
+        free_list = node;
+    }
+    
+    // 释放全部节点，代价与块数成正比
+    void reset() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ::operator delete(chunks[i]);
+        }
+        chunks.clear();
+        chunk_used = CHUNK_SIZE;
+        free_list = nullptr;
     }
 };
 
 // 链栈类
 class LinkedStack {
 private:
-    OutOrderNode* top;          // 栈顶指针
+    StackNode* top;             // 栈顶指针
     int size;                   // 栈的大小
+    NodePool<StackNode> nodes;  // 节点池
+    StringArena strings;        // 字符串驻留区
+    std::unordered_map<DayId, DaySegment> days; // 日序号 -> 当日汇总
+    std::mutex lock;            // 并发出库时入栈、出栈互斥（查询、归档仍在单线程中进行）
     
 public:
     // 构造函数和析构函数
@@ -56,9 +161,15 @@ public:
     int getTodayOutTotal(const std::string& date) const;
     int getMedOutTotal(int med_id, const std::string& date) const;
     int getPrescriptionCount(const std::string& date) const;
+    int getTodayOutTotal(DayId day) const;
+    int getMedOutTotal(int med_id, DayId day) const;
+    int getPrescriptionCount(DayId day) const;
+    
+    // 某日的出库汇总，当日无出库返回nullptr
+    const DaySegment* getDaySegment(DayId day) const;
     
     // 获取栈顶元素（用于统计）
-    OutOrderNode* getTop() const { return top; }
+    const StackNode* getTop() const { return top; }
     
     // 遍历栈（用于统计功能）
     void traverse(void (*visit)(OutOrderNode*)) const;
@@ -66,6 +177,7 @@ public:
 private:
     // 辅助函数
     std::string timeToString(time_t t) const;
+    void toOrder(const StackNode* node, OutOrderNode& order) const;
     void clear();  // 清空栈
 };
 
@@ -5,8 +5,20 @@
 #define MAX_NAME_LEN 50
 #define MAX_ORIGIN_LEN 50
 #define MAX_SPEC_LEN 20
-#define MAX_MEDICINES 300
+#define MAX_MEDICINES 300     // ʼʱԶݣ
 #define HISTORY_DAYS 7  // ¼7ʷ
+#define USAGE_WINDOW_DAYS 90            // ʷڣ죩ɲѯ
+#define USAGE_RING_SIZE (USAGE_WINDOW_DAYS + 1)
+
+// ţ1970-01-01Ϊ0"YYYY-MM-DD"ڻ㣬뵥ʱһΣ֮չֻȽ
+typedef int DayId;
+
+// ʷջδ"յۼֵ"ⴰڵĺϼΪۼֵ֮
+typedef struct {
+    DayId last_day;                             // ˵
+    unsigned int cum_usage[USAGE_RING_SIZE];    // յۼ
+    unsigned int cum_active[USAGE_RING_SIZE];   // 
+} UsageHistory;
 
 // ҩƷϢṹ
 typedef struct {
@@ -17,7 +29,7 @@ typedef struct {
     int stock;                  // ǰ
     int warning_threshold;      // Ԥֵ
     int last_usage;             // һ
-    int usage_history[HISTORY_DAYS]; // 7ʷ
+    UsageHistory usage_history; // ʷδڣ
     int is_warning;             // Ԥ״̬0-1-Ԥ
     time_t warning_time;        // Ԥʼʱ
     time_t response_time;       // ԤӦʱ䣨ʱ䣩
@@ -29,6 +41,7 @@ typedef struct {
     int quantity;               // 
     char operator[20];          // Ա
     time_t in_time;             // ʱ
+    DayId day;                  // 
 } InOrder;
 
 // ⵥṹջ
@@ -37,6 +50,7 @@ typedef struct OutOrderNode {
     int quantity;               // 
     char prescription_no[30];   // 
     time_t out_time;            // ʱ
+    DayId day;                  // 
     struct OutOrderNode *next;  // һڵָ
 } OutOrderNode;
 
@@ -0,0 +1,270 @@
+// metrics.cpp
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include "metrics.h"
+
+using namespace std;
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// 按线程分片累计：调用计数先记在线程局部变量里，每满采样间隔才计一次时、写一次共享分片，热路径上只多一次自增和比较；
+// 直方图按2的幂分段、每段再均分16档（HDR直方图的做法），相对误差约6%，覆盖1纳秒到约18分钟
+#define METRIC_SHARDS 16                // 分片数，每个线程固定写其中一片
+#define METRIC_SUB_BITS 4
+#define METRIC_SUB_BUCKETS (1 << METRIC_SUB_BITS)
+#define METRIC_MAX_BITS 40
+#define METRIC_BUCKETS ((METRIC_MAX_BITS - METRIC_SUB_BITS + 2) * METRIC_SUB_BUCKETS)
+
+const MetricInfo METRIC_INFO[METRIC_COUNT] = {
+    {"findMedicine", 6},
+    {"enqueue", 6},
+    {"dequeue", 6},
+    {"LinkedStack::push", 6},
+    {"LinkedStack::pop", 6},
+    {"checkAndHandleWarnings", 3},
+    {"generateDailyReport", 0},
+    {"generateInReport", 0},
+    {"generateUsageReport", 0},
+    {"generateWarningReport", 0},
+};
+
+struct alignas(CACHE_LINE_SIZE) MetricShard {
+    atomic<unsigned long long> calls[METRIC_COUNT];         // 调用次数（按采样间隔累加）
+    atomic<unsigned long long> total_ns[METRIC_COUNT];      // 计时样本的总耗时
+    atomic<unsigned long long> max_ns[METRIC_COUNT];
+    atomic<unsigned int> buckets[METRIC_COUNT][METRIC_BUCKETS];
+    atomic<unsigned long long> hour_calls[METRIC_COUNT][24];    // 按钟点（本地时间）
+    atomic<unsigned long long> hour_ns[METRIC_COUNT][24];
+    atomic<unsigned long long> hour_samples[METRIC_COUNT][24];
+    atomic<unsigned long long> hour_max_ns[METRIC_COUNT][24];
+};
+
+MetricShard g_metric_shards[METRIC_SHARDS];
+atomic<long long> g_metrics_since((long long)time(nullptr));   // 开始统计（启动或清零）的时间
+
+// 耗时（纳秒）所在的直方图档位
+inline int metricBucket(unsigned long long ns) {
+    if (ns < METRIC_SUB_BUCKETS) return (int)ns;
+    int e = 63;
+    while (!(ns >> e)) e--;
+    if (e > METRIC_MAX_BITS) return METRIC_BUCKETS - 1;
+    return (e - METRIC_SUB_BITS + 1) * METRIC_SUB_BUCKETS + (int)((ns >> (e - METRIC_SUB_BITS)) - METRIC_SUB_BUCKETS);
+}
+
+// 档位代表的耗时（取档内中点）
+unsigned long long metricBucketValue(int bucket) {
+    if (bucket < METRIC_SUB_BUCKETS) return bucket;
+    int e = bucket / METRIC_SUB_BUCKETS + METRIC_SUB_BITS - 1;
+    unsigned long long lower = (unsigned long long)(bucket % METRIC_SUB_BUCKETS + METRIC_SUB_BUCKETS) << (e - METRIC_SUB_BITS);
+    return lower + ((1ULL << (e - METRIC_SUB_BITS)) >> 1);
+}
+
+inline void atomicMaxUll(atomic<unsigned long long>& target, unsigned long long value) {
+    unsigned long long cur = target.load(memory_order_relaxed);
+    while (value > cur && !target.compare_exchange_weak(cur, value, memory_order_relaxed)) {}
+}
+
+MetricShard& threadMetricShard() {
+    static atomic<int> next_shard(0);
+    static thread_local MetricShard *shard = &g_metric_shards[next_shard.fetch_add(1, memory_order_relaxed) % METRIC_SHARDS];
+    return *shard;
+}
+
+// 当前钟点；每个线程只在跨小时后才重新换算本地时间
+int currentMetricHour() {
+    static thread_local time_t hour_end = 0;
+    static thread_local int hour = 0;
+    time_t now = time(nullptr);
+    if (now >= hour_end) {
+        tm *t = localtime(&now);
+        hour = t->tm_hour;
+        hour_end = now + (59 - t->tm_min) * 60 + (60 - t->tm_sec);
+    }
+    return hour;
+}
+
+// 记一个计时样本，代表最近2^sample_shift次调用
+void recordMetric(int metric, unsigned long long ns) {
+    MetricShard& s = threadMetricShard();
+    unsigned long long calls = 1ULL << METRIC_INFO[metric].sample_shift;
+    int hour = currentMetricHour();
+    s.calls[metric].fetch_add(calls, memory_order_relaxed);
+    s.total_ns[metric].fetch_add(ns, memory_order_relaxed);
+    atomicMaxUll(s.max_ns[metric], ns);
+    s.buckets[metric][metricBucket(ns)].fetch_add(1, memory_order_relaxed);
+    s.hour_calls[metric][hour].fetch_add(calls, memory_order_relaxed);
+    s.hour_ns[metric][hour].fetch_add(ns, memory_order_relaxed);
+    s.hour_samples[metric][hour].fetch_add(1, memory_order_relaxed);
+    atomicMaxUll(s.hour_max_ns[metric][hour], ns);
+}
+
+// 各分片汇总后的一项指标
+struct MetricSummary {
+    unsigned long long calls;
+    unsigned long long samples;
+    unsigned long long total_ns;
+    unsigned long long max_ns;
+    vector<unsigned long long> buckets;
+    unsigned long long hour_calls[24];
+    unsigned long long hour_ns[24];
+    unsigned long long hour_samples[24];
+    unsigned long long hour_max_ns[24];
+};
+
+MetricSummary collectMetric(int metric) {
+    MetricSummary m;
+    m.calls = m.samples = m.total_ns = m.max_ns = 0;
+    m.buckets.assign(METRIC_BUCKETS, 0);
+    for (int h = 0; h < 24; h++) m.hour_calls[h] = m.hour_ns[h] = m.hour_samples[h] = m.hour_max_ns[h] = 0;
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        MetricShard& s = g_metric_shards[i];
+        m.calls += s.calls[metric].load(memory_order_relaxed);
+        m.total_ns += s.total_ns[metric].load(memory_order_relaxed);
+        m.max_ns = max(m.max_ns, s.max_ns[metric].load(memory_order_relaxed));
+        for (int b = 0; b < METRIC_BUCKETS; b++) {
+            unsigned int n = s.buckets[metric][b].load(memory_order_relaxed);
+            m.buckets[b] += n;
+            m.samples += n;
+        }
+        for (int h = 0; h < 24; h++) {
+            m.hour_calls[h] += s.hour_calls[metric][h].load(memory_order_relaxed);
+            m.hour_ns[h] += s.hour_ns[metric][h].load(memory_order_relaxed);
+            m.hour_samples[h] += s.hour_samples[metric][h].load(memory_order_relaxed);
+            m.hour_max_ns[h] = max(m.hour_max_ns[h], s.hour_max_ns[metric][h].load(memory_order_relaxed));
+        }
+    }
+    return m;
+}
+
+// 直方图的百分位（纳秒）
+unsigned long long metricPercentile(const MetricSummary& m, double p) {
+    if (m.samples == 0) return 0;
+    unsigned long long rank = (unsigned long long)(p * (m.samples - 1)) + 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < METRIC_BUCKETS; b++) {
+        seen += m.buckets[b];
+        if (seen >= rank) return min(metricBucketValue(b), m.max_ns);
+    }
+    return m.max_ns;
+}
+
+void resetMetrics() {
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        MetricShard& s = g_metric_shards[i];
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            s.calls[k].store(0, memory_order_relaxed);
+            s.total_ns[k].store(0, memory_order_relaxed);
+            s.max_ns[k].store(0, memory_order_relaxed);
+            for (int b = 0; b < METRIC_BUCKETS; b++) s.buckets[k][b].store(0, memory_order_relaxed);
+            for (int h = 0; h < 24; h++) {
+                s.hour_calls[k][h].store(0, memory_order_relaxed);
+                s.hour_ns[k][h].store(0, memory_order_relaxed);
+                s.hour_samples[k][h].store(0, memory_order_relaxed);
+                s.hour_max_ns[k][h].store(0, memory_order_relaxed);
+            }
+        }
+    }
+    g_metrics_since.store((long long)time(nullptr));
+}
+
+// 输出文本报告：各操作的调用数与延迟分布，各钟点的调用量和耗时最多的操作，高峰钟点的分项明细
+void dumpMetrics(ostream& out) {
+    vector<MetricSummary> all;
+    for (int k = 0; k < METRIC_COUNT; k++) all.push_back(collectMetric(k));
+
+    time_t since = (time_t)g_metrics_since.load();
+    char since_str[20];
+    strftime(since_str, sizeof(since_str), "%Y-%m-%d %H:%M:%S", localtime(&since));
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << "==================== 系统运行指标 ====================" << endl;
+    out << "统计起点：" << since_str << "（调用数按采样间隔累加，耗时单位：微秒）" << endl;
+    out << left << setw(24) << "操作" << right << setw(12) << "调用数" << setw(9) << "采样"
+        << setw(10) << "平均" << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99"
+        << setw(10) << "p99.9" << setw(11) << "最大" << endl;
+    out << fixed << setprecision(2);
+    for (int k = 0; k < METRIC_COUNT; k++) {
+        const MetricSummary& m = all[k];
+        if (m.calls == 0) continue;
+        out << left << setw(24) << METRIC_INFO[k].name << right << setw(12) << m.calls
+            << setw(9) << m.samples
+            << setw(10) << m.total_ns / 1000.0 / m.samples
+            << setw(10) << metricPercentile(m, 0.50) / 1000.0
+            << setw(10) << metricPercentile(m, 0.90) / 1000.0
+            << setw(10) << metricPercentile(m, 0.99) / 1000.0
+            << setw(10) << metricPercentile(m, 0.999) / 1000.0
+            << setw(11) << m.max_ns / 1000.0 << endl;
+    }
+
+    // 各钟点估算的总耗时 = 平均耗时 × 调用数
+    out << "\n按钟点：" << endl;
+    out << left << setw(6) << "钟点" << right << setw(12) << "调用数" << setw(14) << "估算耗时(ms)"
+        << "  耗时最多的操作" << endl;
+    int peak_hour = -1;
+    unsigned long long peak_calls = 0;
+    for (int h = 0; h < 24; h++) {
+        unsigned long long calls = 0;
+        double hour_ms = 0.0, top_ms = -1.0;
+        int top = -1;
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            const MetricSummary& m = all[k];
+            if (m.hour_samples[h] == 0) continue;
+            double ms = (double)m.hour_ns[h] / m.hour_samples[h] * m.hour_calls[h] / 1e6;
+            calls += m.hour_calls[h];
+            hour_ms += ms;
+            if (ms > top_ms) {
+                top_ms = ms;
+                top = k;
+            }
+        }
+        if (calls == 0) continue;
+        if (calls > peak_calls) {
+            peak_calls = calls;
+            peak_hour = h;
+        }
+        out << left << setw(6) << (to_string(h) + "时") << right << setw(12) << calls
+            << setw(14) << hour_ms << "  " << METRIC_INFO[top].name << endl;
+    }
+
+    if (peak_hour >= 0) {
+        out << "\n高峰钟点 " << peak_hour << " 时（按估算耗时排序）：" << endl;
+        out << left << setw(24) << "操作" << right << setw(12) << "调用数" << setw(10) << "平均"
+            << setw(11) << "最大" << setw(14) << "估算耗时(ms)" << endl;
+        vector<pair<double, int>> order;
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            const MetricSummary& m = all[k];
+            if (m.hour_samples[peak_hour] == 0) continue;
+            order.push_back(make_pair((double)m.hour_ns[peak_hour] / m.hour_samples[peak_hour] *
+                                      m.hour_calls[peak_hour] / 1e6, k));
+        }
+        sort(order.rbegin(), order.rend());
+        for (size_t i = 0; i < order.size(); i++) {
+            const MetricSummary& m = all[order[i].second];
+            out << left << setw(24) << METRIC_INFO[order[i].second].name << right
+                << setw(12) << m.hour_calls[peak_hour]
+                << setw(10) << m.hour_ns[peak_hour] / 1000.0 / m.hour_samples[peak_hour]
+                << setw(11) << m.hour_max_ns[peak_hour] / 1000.0
+                << setw(14) << order[i].first << endl;
+        }
+    }
+    out << "======================================================" << endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+int dumpMetricsToFile(const char *filename) {
+    ofstream file(filename, ios::out | ios::trunc);
+    if (!file) return -1;
+    dumpMetrics(file);
+    return file.good() ? 0 : -1;
+}
+
@@ -0,0 +1,74 @@
+//ӿʮ ָ 
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <chrono>
+#include <ostream>
+
+#define METRIC_FILE "metrics.txt"
+
+// ·
+enum MetricId {
+    METRIC_FIND_MEDICINE = 0,   // findMedicine
+    METRIC_ENQUEUE,             //  enqueue
+    METRIC_DEQUEUE,             //  dequeue
+    METRIC_STACK_PUSH,          // LinkedStack::push
+    METRIC_STACK_POP,           // LinkedStack::pop
+    METRIC_CHECK_WARNINGS,      // checkAndHandleWarnings
+    METRIC_DAILY_REPORT,        // Statistics::generateDailyReport
+    METRIC_IN_REPORT,           // Statistics::generateInReport
+    METRIC_USAGE_REPORT,        // Statistics::generateUsageReport
+    METRIC_WARNING_REPORT,      // Statistics::generateWarningReport
+    METRIC_COUNT
+};
+
+typedef struct {
+    const char *name;
+    int sample_shift;           // ÿ2^sample_shiftεüʱһ
+} MetricInfo;
+
+extern const MetricInfo METRIC_INFO[METRIC_COUNT];
+
+// һʱ2^sample_shiftεãд뱾̵߳ķƬ
+// HDRʽֱͼ2ݷֶΡÿ16Ͱӵĵ/ʱ
+void recordMetric(int metric, unsigned long long ns);
+
+// ʱڱͷһɡüȼֲ߳̾
+// ÿƵ64ΡԤ8ΡÿΣʱһʱNO_METRICSʱΪղ
+class MetricTimer {
+#ifndef NO_METRICS
+private:
+    int metric;
+    bool sampled;
+    std::chrono::steady_clock::time_point start;
+
+    static bool tick(int metric) {
+        static thread_local unsigned int ticks[METRIC_COUNT];
+        if (++ticks[metric] < (1u << METRIC_INFO[metric].sample_shift)) return false;
+        ticks[metric] = 0;
+        return true;
+    }
+
+public:
+    explicit MetricTimer(int m) : metric(m), sampled(tick(m)) {
+        if (sampled) start = std::chrono::steady_clock::now();
+    }
+    ~MetricTimer() {
+        if (sampled) {
+            recordMetric(metric, (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+#else
+public:
+    explicit MetricTimer(int) {}
+#endif
+};
+
+// ı棺ƽ/p50/p90/p99/p99.9/ʱӵĵʱĲ
+// Լ߷ӵܺʱ˵11ϵͳָꡱʾɵMETRIC_FILE
+void dumpMetrics(std::ostream& out);
+int dumpMetricsToFile(const char *filename);
+void resetMetrics();            // 㣬ͳΪǰʱ
+
+#endif
@@ -4,27 +4,48 @@
 //ӿڶ  
 #include "medicine.h"
 
+// ֶд棺Ԥɨ衢ϼֻ⼸Уmedicines±һһӦ
+typedef struct {
+    int *ids;                   // ҩƷ
+    int *stock;                 // 
+    int *threshold;             // Ԥֵ
+    unsigned char *warning;     // Ԥ״̬
+    time_t *warning_time;       // Ԥʼʱ
+    time_t *response_time;      // Ԥʱ
+} MedicineColumns;
+
+// ƣֻȡҩƷ֮俿ϵCASУ
+// ҩƷɾļ¼Ԥȡд̷߳Ƭ֮䲻
+class StructureLock;
+
 // ˳ṹ
 typedef struct {
-    Medicine *medicines;        // ҩƷ
+    Medicine *medicines;        // ҩƷ飨¼Medicine*ʣ
+    MedicineColumns hot;        // ֶд
     int length;                 // ǰ
     int capacity;               // 
+    StructureLock *lock;        // Ƭд
 } OrderedList;
 
 // ʼ
 OrderedList* createOrderedList(int capacity);
 void destroyOrderedList(OrderedList *list);
+void reserveOrderedList(OrderedList *list, int min_capacity);  // ݣ2
 
 // 
-int insertMedicine(OrderedList *list, Medicine med);      // 벢
+int insertMedicine(OrderedList *list, Medicine med);      // 벢򣨶ֲҲλã
+int insertMedicines(OrderedList *list, const Medicine *meds, int count); // 루һι鲢
 int deleteMedicine(OrderedList *list, int id);            // IDɾ
-Medicine* findMedicine(OrderedList *list, int id);        // IDңֲң
+Medicine* findMedicine(OrderedList *list, int id);        // IDңϣO(1)ָɾʧЧ˵߳ʹã
+int findMedicineSlot(OrderedList *list, int id);          // ID±꣬δҵ-1
 int updateMedicine(OrderedList *list, Medicine med);      // ҩƷϢ
 
-// 
-int increaseStock(OrderedList *list, int id, int quantity);   // ӿ
-int decreaseStock(OrderedList *list, int id, int quantity);   // ٿ
+// ɶ̲߳ã
+int increaseStock(OrderedList *list, int id, int quantity);   // ӿ棨ԭӼӣ
+int decreaseStock(OrderedList *list, int id, int quantity);   // ٿ棨CASۼ治㷵-2
 int getCurrentStock(OrderedList *list, int id);               // ȡǰ
+long long getTotalStock(OrderedList *list);                   // ϼƣֻУ
+int countWarningMedicines(OrderedList *list);                 // ԤеҩƷֻ״̬У
 
 // Ԥ
 int checkWarningStatus(OrderedList *list, int id);            // ǷҪԤ
@@ -36,7 +57,25 @@ void traverseList(OrderedList *list, void (*visit)(Medicine*)); // 
 Medicine* getMedicineByIndex(OrderedList *list, int index);     // ȡ
 
 // ļ
-int saveToFile(OrderedList *list, const char *filename);       // 浽ļ
-OrderedList* loadFromFile(const char *filename);               // ļ
+// ؽֻļʱܴӿտ濪ʼܸԭļ汾1ļʱԶת
+enum LoadStatus {
+    LOAD_OK = 0,
+    LOAD_MISSING,               // ļڣ״У
+    LOAD_CORRUPT,               // ļضϻУͲ
+    LOAD_UNSUPPORTED,           // 汾¼ֲ
+    LOAD_IO_ERROR               // ļڵ޷ȡ
+};
+int saveToFile(OrderedList *list, const char *filename);       // 浽ļͳͼΪfilename.daily
+OrderedList* loadFromFile(const char *filename, LoadStatus *status); // ļأʧʱ*statusԭ
+
+// CSV루ʽȡԶʶUTF-8/GBK
+typedef struct {
+    int rows;                   // ȡ
+    int imported;               // ɹҩƷ¼
+    int skipped;                // ʽظ
+} CsvImportResult;
+
+CsvImportResult importMedicineCsv(OrderedList *list, const char *filename); // ,,,,(g),ֵ(g)
+CsvImportResult importUsageCsv(OrderedList *list, const char *filename);    // ,ҩ(ZY),...ÿһգ
 
 #endif
@@ -5,8 +5,10 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <ctime>
 #include "statistics.h"
+#include "metrics.h"
 
 using namespace std;
 
@@ -34,8 +36,9 @@ Statistics::DailyStats Statistics::getDailyStats(const std::string& date) const
     // 我们需要使用已有接口统计
     
     // 这里简化实现，实际应该遍历出库栈
-    stats.prescription_count = out_stack->getPrescriptionCount(date);
-    stats.total_dosage = out_stack->getTodayOutTotal(date);
+    DayId day = dateToDayId(date);
+    stats.prescription_count = out_stack->getPrescriptionCount(day);
+    stats.total_dosage = out_stack->getTodayOutTotal(day);
     
     // 统计入库单数量（需要入库队列提供接口）
     // 这里暂时返回0，实际实现需要入库队列提供接口
@@ -44,24 +47,8 @@ Statistics::DailyStats Statistics::getDailyStats(const std::string& date) const
 }
 
 std::vector<MedicineUsage> Statistics::getMedicineUsage(const std::string& date) const {
-    vector<MedicineUsage> usage_list;
-    
-    if (!out_stack) {
-        return usage_list;
-    }
-    
-    // 使用map临时存储统计结果
-    map<int, pair<string, int>> usage_map; // med_id -> (med_name, total_usage)
-    map<int, int> frequency_map;           // med_id -> frequency
-    
-    // 遍历出库栈统计用量
-    // 由于链栈没有提供遍历接口，这里需要修改链栈添加遍历功能
-    // 或者使用已有接口进行统计
-    
-    // 这里简化实现，返回空列表
-    // 实际实现需要遍历出库栈的所有订单
-    
-    return usage_list;
+    DayId day = dateToDayId(date);
+    return aggregateUsage(day, day, 0, false);
 }
 
 double Statistics::getAvgResponseTime(const std::string& date) const {
@@ -76,77 +63,22 @@ double Statistics::getAvgResponseTime(const std::string& date) const {
 }
 
 // ==================== 排序功能 ====================
-std::vector<MedicineUsage> Statistics::getUsageRanking(int days) const {
-    vector<MedicineUsage> ranking;
-    
-    // 获取最近dates天的所有日期
-    vector<string> recent_dates = getRecentDates(days);
-    
-    // 这里简化实现，实际应该合并多天的数据
-    // 遍历出库栈，统计每个药品在最近days天的总用量
-    
-    // 创建一些测试数据用于演示
-    ranking.push_back(MedicineUsage(1001, "当归"));
-    ranking.push_back(MedicineUsage(1002, "黄芪"));
-    ranking.push_back(MedicineUsage(1003, "枸杞"));
-    ranking.push_back(MedicineUsage(1004, "人参"));
-    ranking.push_back(MedicineUsage(1005, "甘草"));
-    
-    // 设置测试用量
-    ranking[0].total_usage = 150;
-    ranking[1].total_usage = 120;
-    ranking[2].total_usage = 90;
-    ranking[3].total_usage = 75;
-    ranking[4].total_usage = 60;
-    
-    // 计算总用量
-    int total = 0;
-    for (auto& item : ranking) {
-        total += item.total_usage;
-    }
-    
-    // 计算百分比
-    if (total > 0) {
-        for (auto& item : ranking) {
-            item.usage_percentage = (item.total_usage * 100.0) / total;
-        }
-    }
-    
-    // 按用量降序排序
-    sort(ranking.begin(), ranking.end());
-    
-    return ranking;
+std::vector<MedicineUsage> Statistics::getUsageRanking(int days, size_t top_k) const {
+    DayId today = timeToDayId(time(nullptr));
+    return aggregateUsage(today - days + 1, today, top_k, false);
 }
 
-std::vector<MedicineUsage> Statistics::getFrequencyRanking(int days) const {
-    vector<MedicineUsage> ranking;
-    
-    // 创建测试数据
-    ranking.push_back(MedicineUsage(1002, "黄芪"));
-    ranking.push_back(MedicineUsage(1001, "当归"));
-    ranking.push_back(MedicineUsage(1003, "枸杞"));
-    ranking.push_back(MedicineUsage(1005, "甘草"));
-    ranking.push_back(MedicineUsage(1004, "人参"));
-    
-    // 设置测试频次
-    ranking[0].usage_frequency = 25;
-    ranking[1].usage_frequency = 20;
-    ranking[2].usage_frequency = 18;
-    ranking[3].usage_frequency = 15;
-    ranking[4].usage_frequency = 12;
-    
-    // 按频次降序排序
-    sort(ranking.begin(), ranking.end(), compareByFrequency);
-    
-    return ranking;
+std::vector<MedicineUsage> Statistics::getFrequencyRanking(int days, size_t top_k) const {
+    DayId today = timeToDayId(time(nullptr));
+    return aggregateUsage(today - days + 1, today, top_k, true);
 }
 
 void Statistics::compareThreeDaysUsage() const {
     cout << "\n========== 近三日药物用量对比 ==========" << endl;
     
     // 获取最近三天的用量排名
-    vector<MedicineUsage> usage_ranking = getUsageRanking(3);
-    vector<MedicineUsage> freq_ranking = getFrequencyRanking(3);
+    vector<MedicineUsage> usage_ranking = getUsageRanking(3, 5);
+    vector<MedicineUsage> freq_ranking = getFrequencyRanking(3, 5);
     
     // 显示用量排名
     cout << "\n1. 近三日用量排名（前5名）：" << endl;
@@ -217,6 +149,7 @@ void Statistics::compareThreeDaysUsage() const {
 
 // ==================== 报表生成功能 ====================
 void Statistics::generateDailyReport(const std::string& date) const {
+    MetricTimer timer(METRIC_DAILY_REPORT);
     cout << "\n==========================================" << endl;
     cout << "          药房日常统计报表" << endl;
     cout << "日期：" << date << endl;
@@ -267,6 +200,7 @@ void Statistics::generateDailyReport(const std::string& date) const {
 }
 
 void Statistics::generateUsageReport(int days) const {
+    MetricTimer timer(METRIC_USAGE_REPORT);
     cout << "\n==========================================" << endl;
     cout << "          近" << days << "日药品使用统计" << endl;
     cout << "统计日期：" << getCurrentDate() << endl;
@@ -329,6 +263,7 @@ void Statistics::generateUsageReport(int days) const {
 }
 
 void Statistics::generateWarningReport() const {
+    MetricTimer timer(METRIC_WARNING_REPORT);
     cout << "\n==========================================" << endl;
     cout << "          预警响应统计报表" << endl;
     cout << "统计日期：" << getCurrentDate() << endl;
@@ -390,11 +325,56 @@ std::vector<std::string> Statistics::getRecentDates(int days) const {
 
 bool Statistics::isDateInRange(const std::string& date, int days) const {
     // 检查日期是否在最近days天内
-    vector<string> recent_dates = getRecentDates(days);
-    for (const auto& d : recent_dates) {
-        if (d == date) {
-            return true;
+    int days_ago = timeToDayId(time(nullptr)) - dateToDayId(date);
+    return days_ago >= 0 && days_ago < days;
+}
+
+// 汇总[first_day, last_day]内各药品的用量和频次，取前top_k名（0表示全部）。
+// 逐日读取出库栈的按日汇总，代价与天数和当日药品种数成正比，与出库单总数无关
+std::vector<MedicineUsage> Statistics::aggregateUsage(DayId first_day, DayId last_day, size_t top_k,
+                                                      bool by_frequency) const {
+    vector<MedicineUsage> usage_list;
+    if (!out_stack) {
+        return usage_list;
+    }
+    
+    unordered_map<int, size_t> slots;   // med_id -> usage_list下标
+    for (DayId day = first_day; day <= last_day; day++) {
+        const DaySegment* segment = out_stack->getDaySegment(day);
+        if (segment == nullptr) continue;
+        for (const auto& med : segment->meds) {
+            auto it = slots.find(med.first);
+            if (it == slots.end()) {
+                it = slots.emplace(med.first, usage_list.size()).first;
+                usage_list.push_back(MedicineUsage(med.first, med.second.med_name));
+            }
+            MedicineUsage& item = usage_list[it->second];
+            item.total_usage += med.second.quantity;
+            item.usage_frequency += med.second.count;
         }
     }
-    return false;
+    
+    long long total = 0;
+    for (const auto& item : usage_list) {
+        total += item.total_usage;
+    }
+    if (total > 0) {
+        for (auto& item : usage_list) {
+            item.usage_percentage = (item.total_usage * 100.0) / total;
+        }
+    }
+    
+    // 只对前top_k名排序
+    auto cmp = [by_frequency](const MedicineUsage& a, const MedicineUsage& b) {
+        int ka = by_frequency ? a.usage_frequency : a.total_usage;
+        int kb = by_frequency ? b.usage_frequency : b.total_usage;
+        return ka != kb ? ka > kb : a.med_id < b.med_id;
+    };
+    if (top_k == 0 || top_k > usage_list.size()) {
+        top_k = usage_list.size();
+    }
+    partial_sort(usage_list.begin(), usage_list.begin() + top_k, usage_list.end(), cmp);
+    usage_list.resize(top_k);
+    
+    return usage_list;
 }
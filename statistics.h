@@ -45,7 +45,7 @@ public:
         int total_dosage;               // 总剂量
         int in_orders_count;            // 入库单数量
         int out_orders_count;           // 出库单数量
-        double avg_response_time;       // 平均响应时间
+        double avg_response_time;       // 当日解除预警的平均响应时间（小时）
         
         DailyStats(const std::string& d = "") : date(d), prescription_count(0),
             total_dosage(0), in_orders_count(0), out_orders_count(0), avg_response_time(0.0) {}
@@ -57,8 +57,8 @@ public:
     double getAvgResponseTime(const std::string& date) const;
     
     // 排序功能（题目要求：近三日药物用量和使用频次的排序和对比）
-    std::vector<MedicineUsage> getUsageRanking(int days = 3) const;
-    std::vector<MedicineUsage> getFrequencyRanking(int days = 3) const;
+    std::vector<MedicineUsage> getUsageRanking(int days = 3, size_t top_k = 0) const;     // top_k为0时返回全部
+    std::vector<MedicineUsage> getFrequencyRanking(int days = 3, size_t top_k = 0) const;
     void compareThreeDaysUsage() const;
     
     // 报表生成
@@ -75,6 +75,7 @@ private:
     std::string getCurrentDate() const;
     std::vector<std::string> getRecentDates(int days) const;
     bool isDateInRange(const std::string& date, int days) const;
+    std::vector<MedicineUsage> aggregateUsage(DayId first_day, DayId last_day, size_t top_k, bool by_frequency) const;
 };
 
 #endif // STATISTICS_H
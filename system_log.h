@@ -0,0 +1,21 @@
+//ӿھ ṹ첽־ 
+#ifndef _SYSTEM_LOG_H
+#define _SYSTEM_LOG_H
+
+#define LOG_FILE "system.log"
+#define LOG_RING_SIZE 4096          // λ2ݣʱ
+#define LOG_MESSAGE_LEN 192         // ޣض
+#define LOG_COMPONENT_LEN 16
+
+// ־
+enum LogLevel { LOG_DEBUG = 0, LOG_INFO, LOG_WARN, LOG_ERROR };
+
+// ֹֹͣͣʱдʣļ¼
+bool startSystemLog(const char *filename, int min_level);
+void stopSystemLog();
+
+// һ־÷ͬprintf߳̿ɵãֻдڴ滺壬
+// ɺ̨߳дJSONУ{"ts":..,"level":..,"component":..,"msg":..}
+void logEvent(int level, const char *component, const char *fmt, ...);
+
+#endif
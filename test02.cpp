@@ -6,11 +6,61 @@
 #include <conio.h>
 #include <ctime>
 #include <cstring>
+#include <cstddef>
+#include <cctype>
 #include <iomanip>
 #include <algorithm>
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <climits>
+#include <cstdarg>
+#include <cerrno>
+#include <csignal>
+#include <cmath>
+#ifdef _WIN32
+#define NOMINMAX
+#define FD_SETSIZE 1024
+#include <winsock2.h>
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <psapi.h>
+#include <sys/stat.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <iconv.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace std;
 
@@ -18,8 +68,20 @@ using namespace std;
 #define MAX_NAME_LEN 50
 #define MAX_ORIGIN_LEN 50
 #define MAX_SPEC_LEN 20
-#define MAX_MEDICINES 300
+#define MAX_MEDICINES 300     // ʼʱԶݣ
 #define HISTORY_DAYS 7  // ¼7ʷ
+#define USAGE_WINDOW_DAYS 90            // ʷڣ죩ɲѯ
+#define USAGE_RING_SIZE (USAGE_WINDOW_DAYS + 1)
+
+// ţ1970-01-01Ϊ0"YYYY-MM-DD"ڻ㣬뵥ʱһΣ֮չֻȽ
+typedef int DayId;
+
+// ʷջδ"յۼֵ"ⴰڵĺϼΪۼֵ֮
+typedef struct {
+    DayId last_day;                             // ˵
+    unsigned int cum_usage[USAGE_RING_SIZE];    // յۼ
+    unsigned int cum_active[USAGE_RING_SIZE];   // 
+} UsageHistory;
 
 // ҩƷϢṹ
 typedef struct {
@@ -30,7 +92,7 @@ typedef struct {
     int stock;                  // ǰ
     int warning_threshold;      // Ԥֵ
     int last_usage;             // һ
-    int usage_history[HISTORY_DAYS]; // 7ʷ
+    UsageHistory usage_history; // ʷδڣ
     int is_warning;             // Ԥ״̬0-1-Ԥ
     time_t warning_time;        // Ԥʼʱ
     time_t response_time;       // ԤӦʱ䣨ʱ䣩
@@ -43,6 +105,7 @@ typedef struct {
     char operator_name[20];     // Ա
     time_t in_time;             // ʱ
     char date[11];              // 
+    DayId day;                  // 
 } InOrder;
 
 // ⵥṹջ
@@ -52,1077 +115,6625 @@ typedef struct OutOrderNode {
     char prescription_no[30];   // 
     time_t out_time;            // ʱ
     char date[11];              // 
+    DayId day;                  // 
     struct OutOrderNode *next;  // һڵָ
 } OutOrderNode;
 
-// ordered_list.h - ˳
-typedef struct {
-    Medicine *medicines;        // ҩƷ
-    int length;                 // ǰ
-    int capacity;               // 
-} OrderedList;
+// usage_history.h - ʷδڣȫţ
+DayId g_current_day = 0;        // ǰţֻһֵ
 
-// 
-OrderedList* createOrderedList(int capacity) {
-    OrderedList *list = new OrderedList;
-    list->medicines = new Medicine[capacity];
-    list->length = 0;
-    list->capacity = capacity;
-    return list;
+// "YYYY-MM-DD"תΪţ1970-01-01Ϊ0㣬ʱ
+DayId dateToDayNumber(const char *date) {
+    int y = 0, m = 0, d = 0;
+    if (sscanf(date, "%d-%d-%d", &y, &m, &d) != 3) return -1;
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
 }
 
-// 
-void destroyOrderedList(OrderedList *list) {
-    if (list != nullptr) {
-        delete[] list->medicines;
-        delete list;
+// 㱾ʱ䣨̰߳ȫ̡߳־̲߳ʱlocaltimeľ̬
+void toLocalTime(time_t t, tm *local) {
+#ifdef _WIN32
+    localtime_s(local, &t);
+#else
+    localtime_r(&t, local);
+#endif
+}
+
+// ˢµǰţѭÿεһΣ
+void refreshCurrentDay() {
+    char today[11];
+    tm local;
+    toLocalTime(time(nullptr), &local);
+    strftime(today, sizeof(today), "%Y-%m-%d", &local);
+    g_current_day = dateToDayNumber(today);
+}
+
+inline int usageSlot(DayId day) {
+    return day % USAGE_RING_SIZE;
+}
+
+// dayյۼֵdayڴ㣩
+inline unsigned int usageCumAt(const UsageHistory *h, const unsigned int *cum, DayId day) {
+    return cum[usageSlot(day < h->last_day ? day : h->last_day)];
+}
+
+// ʷƽdayգмûǰһյۼֵ
+void advanceUsageHistory(UsageHistory *h, DayId day) {
+    if (day <= h->last_day) return;
+    unsigned int usage = h->cum_usage[usageSlot(h->last_day)];
+    unsigned int active = h->cum_active[usageSlot(h->last_day)];
+    DayId start = max(h->last_day + 1, day - USAGE_RING_SIZE + 1);
+    for (DayId d = start; d <= day; d++) {
+        h->cum_usage[usageSlot(d)] = usage;
+        h->cum_active[usageSlot(d)] = active;
     }
+    h->last_day = day;
 }
 
-// ֲҩƷ
-Medicine* findMedicine(OrderedList *list, int id) {
-    int left = 0, right = list->length - 1;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        if (list->medicines[mid].id == id) {
-            return &list->medicines[mid];
-        } else if (list->medicines[mid].id < id) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
-        }
+// ĳյdays_ago0Ϊ죩
+int getDayUsage(const Medicine *med, int days_ago) {
+    const UsageHistory *h = &med->usage_history;
+    if (days_ago < 0 || days_ago >= USAGE_WINDOW_DAYS) return 0;
+    DayId today = max(g_current_day, h->last_day);
+    DayId day = today - days_ago;
+    return (int)(usageCumAt(h, h->cum_usage, day) - usageCumAt(h, h->cum_usage, day - 1));
+}
+
+// ĳռΪO(1)ǽյۼֵ
+void recordUsageOnDay(Medicine *med, DayId day, int quantity) {
+    UsageHistory *h = &med->usage_history;
+    advanceUsageHistory(h, day);
+    if (day <= h->last_day - USAGE_WINDOW_DAYS || quantity <= 0) return; // 
+
+    bool first_of_day = (usageCumAt(h, h->cum_usage, day) == usageCumAt(h, h->cum_usage, day - 1));
+    for (DayId d = day; d <= h->last_day; d++) {
+        h->cum_usage[usageSlot(d)] += quantity;
+        if (first_of_day) h->cum_active[usageSlot(d)]++;
     }
-    return nullptr;
 }
 
-// ҩƷ
-int insertMedicine(OrderedList *list, Medicine med) {
-    if (list->length >= list->capacity) {
-        return -1; // 
+// days죨죩O(1)
+int getUsageSum(const Medicine *med, int days) {
+    const UsageHistory *h = &med->usage_history;
+    days = min(days, USAGE_WINDOW_DAYS);
+    DayId today = max(g_current_day, h->last_day);
+    return (int)(usageCumAt(h, h->cum_usage, today) - usageCumAt(h, h->cum_usage, today - days));
+}
+
+// days죨죩O(1)
+int getActiveUsageDays(const Medicine *med, int days) {
+    const UsageHistory *h = &med->usage_history;
+    days = min(days, USAGE_WINDOW_DAYS);
+    DayId today = max(g_current_day, h->last_day);
+    return (int)(usageCumAt(h, h->cum_active, today) - usageCumAt(h, h->cum_active, today - days));
+}
+
+// medicine_index.h - ҩƷϣŶַ̽⣩
+#define INDEX_EMPTY   -1        // ղ
+#define INDEX_DELETED -2        // ɾ
+
+typedef struct {
+    int *slots;                 //  -> ҩƷе±
+    unsigned int *hashes;       //  -> Ĺϣֵʱ¼㣩
+    int capacity;               // 2ݣ
+    int count;                  // Ч
+    int used;                   // Ч + ɾ
+} HashIndex;
+
+void initHashIndex(HashIndex *index, int capacity) {
+    int cap = 16;
+    while (cap < capacity * 2) {
+        cap *= 2;
     }
-    
-    // ҵλ
-    int pos = list->length;
-    for (int i = 0; i < list->length; i++) {
-        if (list->medicines[i].id > med.id) {
-            pos = i;
-            break;
-        }
+    index->slots = new int[cap];
+    index->hashes = new unsigned int[cap];
+    for (int i = 0; i < cap; i++) {
+        index->slots[i] = INDEX_EMPTY;
     }
-    
-    // ƶԪ
-    for (int i = list->length; i > pos; i--) {
-        list->medicines[i] = list->medicines[i-1];
+    index->capacity = cap;
+    index->count = 0;
+    index->used = 0;
+}
+
+void freeHashIndex(HashIndex *index) {
+    delete[] index->slots;
+    delete[] index->hashes;
+    index->slots = nullptr;
+    index->hashes = nullptr;
+    index->capacity = index->count = index->used = 0;
+}
+
+// ϣֵ̽⣬match(±)жǷΪҪҵزۺţҲ-1
+template <typename Match>
+int probeHashIndex(const HashIndex *index, unsigned int hash, Match match) {
+    unsigned int mask = index->capacity - 1;
+    for (unsigned int i = hash & mask; ; i = (i + 1) & mask) {
+        int slot = index->slots[i];
+        if (slot == INDEX_EMPTY) return -1;
+        if (slot != INDEX_DELETED && index->hashes[i] == hash && match(slot)) return i;
     }
-    
-    list->medicines[pos] = med;
-    list->length++;
-    return 0;
 }
 
-// ɾҩƷ
-int deleteMedicine(OrderedList *list, int id) {
-    for (int i = 0; i < list->length; i++) {
-        if (list->medicines[i].id == id) {
-            // ǰƶԪ
-            for (int j = i; j < list->length - 1; j++) {
-                list->medicines[j] = list->medicines[j+1];
-            }
-            list->length--;
-            return 0;
+// ɢУЧʱݣɾǹʱԭؽ
+void rehashIndex(HashIndex *index) {
+    HashIndex old = *index;
+    initHashIndex(index, old.count * 2 > old.capacity / 2 ? old.capacity : old.capacity / 2);
+    unsigned int mask = index->capacity - 1;
+    for (int i = 0; i < old.capacity; i++) {
+        if (old.slots[i] < 0) continue;
+        unsigned int j = old.hashes[i] & mask;
+        while (index->slots[j] != INDEX_EMPTY) {
+            j = (j + 1) & mask;
         }
+        index->slots[j] = old.slots[i];
+        index->hashes[j] = old.hashes[i];
+        index->count++;
+        index->used++;
     }
-    return -1; // δҵ
+    freeHashIndex(&old);
 }
 
-// circular_queue.h - ѭ
-typedef struct {
-    InOrder *orders;            // 
-    int front;                  // ͷָ
-    int rear;                   // βָ
-    int capacity;               // 
-    int size;                   // ǰС
-} CircularQueue;
+void hashIndexInsert(HashIndex *index, unsigned int hash, int slot) {
+    // װӲ1/2֤̽һղ
+    if ((index->used + 1) * 2 > index->capacity) {
+        rehashIndex(index);
+    }
+    unsigned int mask = index->capacity - 1;
+    unsigned int i = hash & mask;
+    while (index->slots[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    if (index->slots[i] == INDEX_EMPTY) {
+        index->used++;
+    }
+    index->slots[i] = slot;
+    index->hashes[i] = hash;
+    index->count++;
+}
 
-// ѭ
-CircularQueue* createQueue(int capacity) {
-    CircularQueue* queue = new CircularQueue;
-    queue->orders = new InOrder[capacity];
-    queue->front = 0;
-    queue->rear = 0;
-    queue->size = 0;
-    queue->capacity = capacity;
-    return queue;
+void hashIndexErase(HashIndex *index, int pos) {
+    index->slots[pos] = INDEX_DELETED;
+    index->count--;
 }
 
-// ٶ
-void destroyQueue(CircularQueue *queue) {
-    if (queue != nullptr) {
-        delete[] queue->orders;
-        delete queue;
-    }
+unsigned int hashMedicineId(int id) {
+    return (unsigned int)id * 2654435761u;
 }
 
-// 
-bool enqueue(CircularQueue *queue, InOrder order) {
-    if (queue->size == queue->capacity) {
-        return false; // 
+// ƹ淶ȥβհףASCIIĸתСд
+void normalizeMedicineName(const char *name, char *out) {
+    const char *begin = name;
+    const char *end = name + strlen(name);
+    while (begin < end && isspace((unsigned char)*begin)) begin++;
+    while (end > begin && isspace((unsigned char)*(end - 1))) end--;
+
+    int len = 0;
+    for (const char *p = begin; p < end && len < MAX_NAME_LEN - 1; p++) {
+        out[len++] = (char)tolower((unsigned char)*p);
     }
-    queue->orders[queue->rear] = order;
-    queue->rear = (queue->rear + 1) % queue->capacity;
-    queue->size++;
-    return true;
+    out[len] = '\0';
 }
 
-// 
-bool dequeue(CircularQueue *queue, InOrder *order) {
-    if (queue->size == 0) {
-        return false; // п
+unsigned int hashMedicineName(const char *normalized) {
+    unsigned int h = 2166136261u; // FNV-1a
+    for (const char *p = normalized; *p; p++) {
+        h = (h ^ (unsigned char)*p) * 16777619u;
     }
-    *order = queue->orders[queue->front];
-    queue->front = (queue->front + 1) % queue->capacity;
-    queue->size--;
-    return true;
+    return h;
 }
 
-// linked_stack.h - ջ
-class LinkedStack {
+// warning_engine.h - Ԥ䶯ֻǼҩƷIDʱֻ䶯ҩƷ
+// "-ֵ"СѣѶӽѵڣֵҩƷ
+class MarginHeap {
 private:
-    OutOrderNode* top;          // ջָ
-    int size;                   // ջĴС
-    
-public:
-    LinkedStack() : top(nullptr), size(0) {}
-    ~LinkedStack() { clear(); }
-    
-    bool isEmpty() const { return top == nullptr; }
-    int getSize() const { return size; }
+    struct Entry {
+        int margin;             //  - ֵ
+        int id;                 // ҩƷID
+    };
+    vector<Entry> heap;
+    unordered_map<int, int> pos;    // ҩƷID -> ±
     
-    void push(int med_id, int quantity, const char* prescription_no, const char* date) {
-        OutOrderNode* newNode = new OutOrderNode;
-        newNode->med_id = med_id;
-        newNode->quantity = quantity;
-        strcpy(newNode->prescription_no, prescription_no);
-        strcpy(newNode->date, date);
-        newNode->out_time = time(nullptr);
-        newNode->next = top;
-        top = newNode;
-        size++;
+    void swapEntries(int a, int b) {
+        swap(heap[a], heap[b]);
+        pos[heap[a].id] = a;
+        pos[heap[b].id] = b;
     }
     
-    bool pop(OutOrderNode& order) {
-        if (top == nullptr) return false;
-        
-        OutOrderNode* temp = top;
-        order = *top;
-        top = top->next;
-        delete temp;
-        size--;
-        return true;
+    void siftUp(int i) {
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (heap[parent].margin <= heap[i].margin) break;
+            swapEntries(i, parent);
+            i = parent;
+        }
     }
     
-    void clear() {
-        while (top != nullptr) {
-            OutOrderNode* temp = top;
-            top = top->next;
-            delete temp;
-            size--;
+    void siftDown(int i) {
+        int n = heap.size();
+        while (true) {
+            int smallest = i;
+            int l = 2 * i + 1, r = 2 * i + 2;
+            if (l < n && heap[l].margin < heap[smallest].margin) smallest = l;
+            if (r < n && heap[r].margin < heap[smallest].margin) smallest = r;
+            if (smallest == i) break;
+            swapEntries(i, smallest);
+            i = smallest;
         }
     }
     
-    OutOrderNode* getTop() const { return top; }
+public:
+    int size() const { return heap.size(); }
     
-    // ȡָڵĳͳ
-    int getDailyOutTotal(const string& date) const {
-        int total = 0;
-        OutOrderNode* current = top;
-        while (current != nullptr) {
-            if (string(current->date) == date) {
-                total += current->quantity;
-            }
-            current = current->next;
+    // ؽԵϽѣO(n)
+    void rebuild(const int *ids, const int *stock, const int *threshold, int n) {
+        heap.resize(n);
+        pos.clear();
+        pos.reserve(n);
+        for (int i = 0; i < n; i++) {
+            heap[i].margin = stock[i] - threshold[i];
+            heap[i].id = ids[i];
+            pos[ids[i]] = i;
         }
-        return total;
-    }
-    
-    // ȡָҩƷĳͳ
-    int getMedicineOutTotal(int med_id, const string& date) const {
-        int total = 0;
-        OutOrderNode* current = top;
-        while (current != nullptr) {
-            if (current->med_id == med_id && string(current->date) == date) {
-                total += current->quantity;
-            }
-            current = current->next;
+        for (int i = n / 2 - 1; i >= 0; i--) {
+            siftDown(i);
         }
-        return total;
     }
     
-    // ȡָڵĴ
-    int getPrescriptionCount(const string& date) const {
-        int count = 0;
-        OutOrderNode* current = top;
-        while (current != nullptr) {
-            if (string(current->date) == date) {
-                count++;
-            }
-            current = current->next;
+    // ҩƷ
+    void update(int id, int margin) {
+        auto it = pos.find(id);
+        if (it == pos.end()) {
+            heap.push_back({margin, id});
+            pos[id] = heap.size() - 1;
+            siftUp(heap.size() - 1);
+            return;
         }
-        return count;
+        int i = it->second;
+        int old = heap[i].margin;
+        heap[i].margin = margin;
+        if (margin < old) siftUp(i);
+        else siftDown(i);
     }
     
-    // ȡָڵгⵥ
-    vector<OutOrderNode> getDailyOrders(const string& date) const {
-        vector<OutOrderNode> orders;
-        OutOrderNode* current = top;
-        while (current != nullptr) {
-            if (string(current->date) == date) {
-                orders.push_back(*current);
-            }
-            current = current->next;
+    void remove(int id) {
+        auto it = pos.find(id);
+        if (it == pos.end()) return;
+        int i = it->second;
+        int last = heap.size() - 1;
+        if (i != last) swapEntries(i, last);
+        heap.pop_back();
+        pos.erase(id);
+        if (i < (int)heap.size()) {
+            siftUp(i);
+            siftDown(i);
         }
-        return orders;
     }
     
-    // ȡгⵥͳ
-    vector<OutOrderNode> getAllOrders() const {
-        vector<OutOrderNode> orders;
-        OutOrderNode* current = top;
-        while (current != nullptr) {
-            orders.push_back(*current);
-            current = current->next;
+    // ռСlimitҩƷIDֻĽ㼰ӽ
+    void collectBelow(int limit, vector<int>& ids) const {
+        vector<int> pending;
+        if (!heap.empty()) pending.push_back(0);
+        while (!pending.empty()) {
+            int i = pending.back();
+            pending.pop_back();
+            if (heap[i].margin >= limit) continue;
+            ids.push_back(heap[i].id);
+            if (2 * i + 1 < (int)heap.size()) pending.push_back(2 * i + 1);
+            if (2 * i + 2 < (int)heap.size()) pending.push_back(2 * i + 2);
         }
-        return orders;
     }
 };
 
-// warning_logic.h - Ԥ߼
-int calculateThreeDayAverage(Medicine *med) {
-    if (med == nullptr) return 0;
-    
-    int sum = 0, count = 0;
-    // ǰD-06D-15D-24
-    int three_days[3] = {
-        med->usage_history[6],  // 
-        med->usage_history[5],  // ǰһ
-        med->usage_history[4]   // ǰ
-    };
+struct WarningEngine {
+    vector<int> dirty;              // ҩƷID
+    unordered_set<int> dirty_set;   // ȥ
+    MarginHeap margins;             // ȫҩƷ
+    int raised;                     // ´Ԥɲ˵ȡ㣩
+    int cleared;                    // ½Ԥ
+    mutex dirty_lock;               // dirty/dirty_set̲߳Ǽǣ
+    WarningEngine() : raised(0), cleared(0) {}
+};
 
-    for (int i = 0; i < 3; i++) {
-        if (three_days[i] > 0) {
-            sum += three_days[i];
-            count++;
-        }
+// Ǽǿֵ仯ҩƷ
+void markWarningDirty(WarningEngine *engine, int id) {
+    lock_guard<mutex> guard(engine->dirty_lock);
+    if (engine->dirty_set.insert(id).second) {
+        engine->dirty.push_back(id);
     }
+}
 
-    return (count == 0) ? 0 : (sum / count);
+// daily_stats_view.h - ͳƵﻯͼǼǡԤʱۼӣձֱӰնȡ
+// ձĳⲿɳջշֶջ/ջͬάlinked_stack.h̨õĸҩƷÿ
+// ڳǼʱ뱾ͼⵥջ٣
+// ͼһ𱣴Ϊ<ļ>.dailyֻ貹Ͽ֮ˮ
+#define DAILY_STATS_SUFFIX ".daily"
+#define DAILY_STATS_MAGIC "TCDS"
+#define DAILY_STATS_VERSION 3                   // 2: ӸҩƷÿ3: ҩƷÿճ
+
+struct DailyAggregate {
+    int in_orders;              // յǼǵⵥ
+    long long in_quantity;      // 
+    int responses;              // սԤ
+    double response_hours;      // ЩԤӴʱϼƣСʱ
+    DailyAggregate() : in_orders(0), in_quantity(0), responses(0), response_hours(0.0) {}
+};
+
+// ҩƷĳյĳ
+struct MedDayMovement {
+    long long in_quantity;
+    long long out_quantity;
+    MedDayMovement() : in_quantity(0), out_quantity(0) {}
+};
+
+struct DailyStatsView {
+    unordered_map<int, DailyAggregate> days;    //  -> ջ
+    map<int, unordered_map<int, MedDayMovement>> meds;  // ţ-> (ҩƷID -> ճ)
+    unsigned int journal_seq;                   // Ѽͼһˮţʱȡͼļ
+    mutex lock;                                 // ̲߳Ǽ
+    DailyStatsView() : journal_seq(0) {}
+};
+
+// ͼļļͷΪcountеĵջܣֱļĩβΪҩƷÿճ
+// 汾2ֻ汾3ΪDailyMedRecord
+typedef struct {
+    char magic[4];              // ļʶ "TCDS"
+    int version;
+    unsigned int journal_seq;   // ͬʱĿһ
+    int count;                  // ջܼ¼
+    unsigned int checksum;      // ļͷ֮ȫֽڵУ
+} DailyStatsHeader;
+
+typedef struct {
+    DayId day;
+    int in_orders;
+    long long in_quantity;
+    int responses;
+    double response_hours;
+} DailyStatsRecord;
+
+typedef struct {
+    DayId day;
+    int med_id;
+    long long quantity;
+} DailyInboundRecord;           // 汾2
+
+typedef struct {
+    DayId day;
+    int med_id;
+    long long in_quantity;
+    long long out_quantity;
+} DailyMedRecord;
+
+void recordDailyInbound(DailyStatsView *view, DayId day, int med_id, int quantity) {
+    lock_guard<mutex> guard(view->lock);
+    DailyAggregate& agg = view->days[day];
+    agg.in_orders++;
+    agg.in_quantity += quantity;
+    view->meds[day][med_id].in_quantity += quantity;
 }
 
-void setWarningThreshold(Medicine *med) {
-    if (med == nullptr) return;
-    
-    int three_day_avg = calculateThreeDayAverage(med);
-    int threshold;
+// ǼǣոҩƷĳⵥջӰ죩
+void recordDailyOutbound(DailyStatsView *view, DayId day, int med_id, int quantity) {
+    lock_guard<mutex> guard(view->lock);
+    view->meds[day][med_id].out_quantity += quantity;
+}
 
-    if (three_day_avg > 0) {
-        threshold = static_cast<int>(three_day_avg * 0.1);
-    } else {
-        threshold = static_cast<int>(med->last_usage * 0.1);
-    }
+// Ԥ
+void recordDailyResponse(DailyStatsView *view, time_t warning_time, time_t response_time) {
+    char date[11];
+    strftime(date, sizeof(date), "%Y-%m-%d", localtime(&response_time));
+    lock_guard<mutex> guard(view->lock);
+    DailyAggregate& agg = view->days[dateToDayNumber(date)];
+    agg.responses++;
+    agg.response_hours += difftime(response_time, warning_time) / 3600.0;
+}
 
-    // ȷֵΪ1ֹ0ֵԶԤ
-    threshold = max(threshold, 1);
-    
-    med->warning_threshold = threshold;
+DailyAggregate getDailyAggregate(DailyStatsView *view, DayId day) {
+    lock_guard<mutex> guard(view->lock);
+    auto it = view->days.find(day);
+    return it == view->days.end() ? DailyAggregate() : it->second;
 }
 
-// ʵʱ鲢Ԥ״̬
-void checkAndHandleWarnings(OrderedList *inventory, int med_id) {
-    if (inventory == nullptr) return;
-    
-    Medicine *med = findMedicine(inventory, med_id);
-    if (med == nullptr) return;
-    
-    time_t now = time(NULL);
-    
-    // Ƿ񴥷Ԥ
-    if (med->stock < med->warning_threshold && med->is_warning == 0) {
-        med->is_warning = 1;
-        med->warning_time = now;
-        cout << "\nԤҩƷID=" << med->id 
-             << "=" << med->name 
-             << "=" << med->stock << "g < ֵ=" << med->warning_threshold << "g" << endl;
-    }
-    // ǷԤ
-    else if (med->stock >= med->warning_threshold && med->is_warning == 1) {
-        med->is_warning = 0;
-        med->response_time = now;
-        double response_hour = difftime(med->response_time, med->warning_time) / 3600.0;
-        cout << "\nԤҩƷID=" << med->id 
-             << "=" << med->name 
-             << "Ӧʱ=" << response_hour << "Сʱ" << endl;
+// ĳոҩƷҩƷID -> ⵥǷѴӰ
+unordered_map<int, long long> getDailyInbound(DailyStatsView *view, DayId day) {
+    unordered_map<int, long long> result;
+    lock_guard<mutex> guard(view->lock);
+    auto it = view->meds.find(day);
+    if (it == view->meds.end()) return result;
+    for (auto med = it->second.begin(); med != it->second.end(); ++med) {
+        if (med->second.in_quantity != 0) result[med->first] = med->second.in_quantity;
     }
+    return result;
 }
 
-// ҩƷԤ״̬
-void updateAllWarnings(OrderedList *inventory) {
-    if (inventory == nullptr || inventory->length == 0) {
-        cout << "棺ΪգԤ״̬" << endl;
-        return;
-    }
+// ̨ĵҩƷݣճԼ֮յľ䶯⣩
+// ӵǰ浹Ƶս
+struct MedLedger {
+    long long in_quantity;
+    long long out_quantity;
+    long long later_net;
+    MedLedger() : in_quantity(0), out_quantity(0), later_net(0) {}
+};
 
-    cout << "\n===== ʼҩƷԤ״̬ =====" << endl;
-    for (int i = 0; i < inventory->length; i++) {
-        checkAndHandleWarnings(inventory, inventory->medicines[i].id);
+// һμֻͼиռ֮г
+unordered_map<int, MedLedger> getDailyLedger(DailyStatsView *view, DayId day) {
+    unordered_map<int, MedLedger> result;
+    lock_guard<mutex> guard(view->lock);
+    for (auto it = view->meds.lower_bound(day); it != view->meds.end(); ++it) {
+        for (auto med = it->second.begin(); med != it->second.end(); ++med) {
+            MedLedger& entry = result[med->first];
+            if (it->first == day) {
+                entry.in_quantity = med->second.in_quantity;
+                entry.out_quantity = med->second.out_quantity;
+            } else {
+                entry.later_net += med->second.in_quantity - med->second.out_quantity;
+            }
+        }
     }
-    cout << "===== Ԥ״̬ =====" << endl;
+    return result;
 }
 
-// ⵥ - 汾еĶظӿ
-bool processInOrder(CircularQueue *queue, OrderedList *inventory) {
-    if (queue == nullptr || inventory == nullptr) {
-        cout << "󣺲Ч" << endl;
-        return false;
-    }
-    
+// medicine_columns.h - ҩƷֶд
+// Ԥɨ衢ϼֻ⼸ֶΣţmedicines±һһӦ
+// medicines¼ơءʷݣӿԷMedicine*
+typedef struct {
+    int *ids;                   // ҩƷ
+    int *stock;                 // 
+    int *threshold;             // Ԥֵ
+    unsigned char *warning;     // Ԥ״̬
+    time_t *warning_time;       // Ԥʼʱ
+    time_t *response_time;      // Ԥʱ
+} MedicineColumns;
+
+void allocMedicineColumns(MedicineColumns *cols, int capacity) {
+    cols->ids = new int[capacity];
+    cols->stock = new int[capacity];
+    cols->threshold = new int[capacity];
+    cols->warning = new unsigned char[capacity];
+    cols->warning_time = new time_t[capacity];
+    cols->response_time = new time_t[capacity];
+}
+
+void freeMedicineColumns(MedicineColumns *cols) {
+    delete[] cols->ids;
+    delete[] cols->stock;
+    delete[] cols->threshold;
+    delete[] cols->warning;
+    delete[] cols->warning_time;
+    delete[] cols->response_time;
+}
+
+// [src, src+n)Ƶdstص
+void moveMedicineColumns(MedicineColumns *cols, int dst, int src, int n) {
+    if (n <= 0) return;
+    memmove(cols->ids + dst, cols->ids + src, sizeof(int) * n);
+    memmove(cols->stock + dst, cols->stock + src, sizeof(int) * n);
+    memmove(cols->threshold + dst, cols->threshold + src, sizeof(int) * n);
+    memmove(cols->warning + dst, cols->warning + src, sizeof(unsigned char) * n);
+    memmove(cols->warning_time + dst, cols->warning_time + src, sizeof(time_t) * n);
+    memmove(cols->response_time + dst, cols->response_time + src, sizeof(time_t) * n);
+}
+
+void storeMedicineColumns(MedicineColumns *cols, int i, const Medicine *med) {
+    cols->ids[i] = med->id;
+    cols->stock[i] = med->stock;
+    cols->threshold[i] = med->warning_threshold;
+    cols->warning[i] = (unsigned char)med->is_warning;
+    cols->warning_time[i] = med->warning_time;
+    cols->response_time[i] = med->response_time;
+}
+
+// inventory_lock.h - 沢
+// ֻȡҩƷ֮俿ϵCASУҩƷɾļ¼Ԥȡд
+#define LOCK_SHARDS 16              // Ƭÿ̶̹߳ʹһƬ
+#define CACHE_LINE_SIZE 64
+
+// ͨintԭӲint飬ɨճȡ
+inline int atomicLoadInt(const int *p) {
+#ifdef _MSC_VER
+    return *(const volatile int*)p;     // intȡԭӵ
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// *p*expectedΪdesiredtrueѵǰֵд*expected
+inline bool atomicCasInt(int *p, int *expected, int desired) {
+#ifdef _MSC_VER
+    long old = _InterlockedCompareExchange((volatile long*)p, desired, *expected);
+    if (old == *expected) return true;
+    *expected = (int)old;
+    return false;
+#else
+    return __atomic_compare_exchange_n(p, expected, desired, true,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// ԭӼӣؼӺֵ
+inline int atomicAddInt(int *p, int delta) {
+#ifdef _MSC_VER
+    return (int)_InterlockedExchangeAdd((volatile long*)p, delta) + delta;
+#else
+    return __atomic_add_fetch(p, delta, __ATOMIC_ACQ_REL);
+#endif
+}
+
+// ƬдֻԼķƬͬһУдסȫƬ
+class StructureLock {
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        shared_mutex m;
+    };
+    Shard shards[LOCK_SHARDS];
+
+    static int threadShard() {
+        static atomic<int> next_shard(0);
+        static thread_local int shard = next_shard.fetch_add(1, memory_order_relaxed) % LOCK_SHARDS;
+        return shard;
+    }
+
+public:
+    int lockShared() {
+        int s = threadShard();
+        shards[s].m.lock_shared();
+        return s;
+    }
+    void unlockShared(int s) { shards[s].m.unlock_shared(); }
+
+    void lock() {
+        for (int i = 0; i < LOCK_SHARDS; i++) shards[i].m.lock();
+    }
+    void unlock() {
+        for (int i = LOCK_SHARDS - 1; i >= 0; i--) shards[i].m.unlock();
+    }
+};
+
+class StructureReadGuard {
+private:
+    StructureLock *lock;
+    int shard;
+public:
+    explicit StructureReadGuard(StructureLock *l) : lock(l), shard(l->lockShared()) {}
+    ~StructureReadGuard() { lock->unlockShared(shard); }
+};
+
+class StructureWriteGuard {
+private:
+    StructureLock *lock;
+public:
+    explicit StructureWriteGuard(StructureLock *l) : lock(l) { lock->lock(); }
+    ~StructureWriteGuard() { lock->unlock(); }
+};
+
+// metrics.h - ָ꣺·üӳֱͼ̷߳ƬĬϱ򣻶NO_METRICSȥ
+// üȼֲ߳̾ÿżһʱдһιƬ·ֻһͱȽϣ
+// ֱͼ2ݷֶΡÿپ16HDRֱͼԼ6%1뵽Լ18
+#define METRIC_FILE "metrics.txt"
+#define METRIC_SHARDS 16                // Ƭÿ̶̹߳дһƬ
+#define METRIC_SUB_BITS 4
+#define METRIC_SUB_BUCKETS (1 << METRIC_SUB_BITS)
+#define METRIC_MAX_BITS 40
+#define METRIC_BUCKETS ((METRIC_MAX_BITS - METRIC_SUB_BITS + 2) * METRIC_SUB_BUCKETS)
+
+enum MetricId {
+    METRIC_FIND_MEDICINE = 0,
+    METRIC_ENQUEUE,
+    METRIC_DEQUEUE,
+    METRIC_STACK_PUSH,
+    METRIC_STACK_POP,
+    METRIC_CHECK_WARNINGS,
+    METRIC_DAILY_REPORT,
+    METRIC_IN_REPORT,
+    METRIC_USAGE_REPORT,
+    METRIC_WARNING_REPORT,
+    METRIC_COUNT
+};
+
+typedef struct {
+    const char *name;
+    int sample_shift;           // ÿ2^sample_shiftεüʱһ
+} MetricInfo;
+
+const MetricInfo METRIC_INFO[METRIC_COUNT] = {
+    {"findMedicine", 6},
+    {"enqueue", 6},
+    {"dequeue", 6},
+    {"LinkedStack::push", 6},
+    {"LinkedStack::pop", 6},
+    {"checkAndHandleWarnings", 3},
+    {"generateDailyReport", 0},
+    {"generateInReport", 0},
+    {"generateUsageReport", 0},
+    {"generateWarningReport", 0},
+};
+
+struct alignas(CACHE_LINE_SIZE) MetricShard {
+    atomic<unsigned long long> calls[METRIC_COUNT];         // ôۼӣ
+    atomic<unsigned long long> total_ns[METRIC_COUNT];      // ʱܺʱ
+    atomic<unsigned long long> max_ns[METRIC_COUNT];
+    atomic<unsigned int> buckets[METRIC_COUNT][METRIC_BUCKETS];
+    atomic<unsigned long long> hour_calls[METRIC_COUNT][24];    // ӵ㣨ʱ䣩
+    atomic<unsigned long long> hour_ns[METRIC_COUNT][24];
+    atomic<unsigned long long> hour_samples[METRIC_COUNT][24];
+    atomic<unsigned long long> hour_max_ns[METRIC_COUNT][24];
+};
+
+MetricShard g_metric_shards[METRIC_SHARDS];
+atomic<long long> g_metrics_since((long long)time(nullptr));   // ʼͳƣ㣩ʱ
+
+// ʱ룩ڵֱͼλ
+inline int metricBucket(unsigned long long ns) {
+    if (ns < METRIC_SUB_BUCKETS) return (int)ns;
+    int e = 63;
+    while (!(ns >> e)) e--;
+    if (e > METRIC_MAX_BITS) return METRIC_BUCKETS - 1;
+    return (e - METRIC_SUB_BITS + 1) * METRIC_SUB_BUCKETS + (int)((ns >> (e - METRIC_SUB_BITS)) - METRIC_SUB_BUCKETS);
+}
+
+// λĺʱȡе㣩
+unsigned long long metricBucketValue(int bucket) {
+    if (bucket < METRIC_SUB_BUCKETS) return bucket;
+    int e = bucket / METRIC_SUB_BUCKETS + METRIC_SUB_BITS - 1;
+    unsigned long long lower = (unsigned long long)(bucket % METRIC_SUB_BUCKETS + METRIC_SUB_BUCKETS) << (e - METRIC_SUB_BITS);
+    return lower + ((1ULL << (e - METRIC_SUB_BITS)) >> 1);
+}
+
+inline void atomicMaxUll(atomic<unsigned long long>& target, unsigned long long value) {
+    unsigned long long cur = target.load(memory_order_relaxed);
+    while (value > cur && !target.compare_exchange_weak(cur, value, memory_order_relaxed)) {}
+}
+
+MetricShard& threadMetricShard() {
+    static atomic<int> next_shard(0);
+    static thread_local MetricShard *shard = &g_metric_shards[next_shard.fetch_add(1, memory_order_relaxed) % METRIC_SHARDS];
+    return *shard;
+}
+
+// ǰӵ㣻ÿֻ߳ڿСʱ»㱾ʱ
+int currentMetricHour() {
+    static thread_local time_t hour_end = 0;
+    static thread_local int hour = 0;
+    time_t now = time(nullptr);
+    if (now >= hour_end) {
+        tm *t = localtime(&now);
+        hour = t->tm_hour;
+        hour_end = now + (59 - t->tm_min) * 60 + (60 - t->tm_sec);
+    }
+    return hour;
+}
+
+// һʱ2^sample_shiftε
+void recordMetric(int metric, unsigned long long ns) {
+    MetricShard& s = threadMetricShard();
+    unsigned long long calls = 1ULL << METRIC_INFO[metric].sample_shift;
+    int hour = currentMetricHour();
+    s.calls[metric].fetch_add(calls, memory_order_relaxed);
+    s.total_ns[metric].fetch_add(ns, memory_order_relaxed);
+    atomicMaxUll(s.max_ns[metric], ns);
+    s.buckets[metric][metricBucket(ns)].fetch_add(1, memory_order_relaxed);
+    s.hour_calls[metric][hour].fetch_add(calls, memory_order_relaxed);
+    s.hour_ns[metric][hour].fetch_add(ns, memory_order_relaxed);
+    s.hour_samples[metric][hour].fetch_add(1, memory_order_relaxed);
+    atomicMaxUll(s.hour_max_ns[metric][hour], ns);
+}
+
+// ʱʱֵǴεʱ¼ʱ
+class MetricTimer {
+#ifndef NO_METRICS
+private:
+    int metric;
+    bool sampled;
+    chrono::steady_clock::time_point start;
+
+    static bool tick(int metric) {
+        static thread_local unsigned int ticks[METRIC_COUNT];
+        if (++ticks[metric] < (1u << METRIC_INFO[metric].sample_shift)) return false;
+        ticks[metric] = 0;
+        return true;
+    }
+
+public:
+    explicit MetricTimer(int m) : metric(m), sampled(tick(m)) {
+        if (sampled) start = chrono::steady_clock::now();
+    }
+    ~MetricTimer() {
+        if (sampled) {
+            recordMetric(metric, (unsigned long long)chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - start).count());
+        }
+    }
+#else
+public:
+    explicit MetricTimer(int) {}
+#endif
+};
+
+// Ƭܺһָ
+struct MetricSummary {
+    unsigned long long calls;
+    unsigned long long samples;
+    unsigned long long total_ns;
+    unsigned long long max_ns;
+    vector<unsigned long long> buckets;
+    unsigned long long hour_calls[24];
+    unsigned long long hour_ns[24];
+    unsigned long long hour_samples[24];
+    unsigned long long hour_max_ns[24];
+};
+
+MetricSummary collectMetric(int metric) {
+    MetricSummary m;
+    m.calls = m.samples = m.total_ns = m.max_ns = 0;
+    m.buckets.assign(METRIC_BUCKETS, 0);
+    for (int h = 0; h < 24; h++) m.hour_calls[h] = m.hour_ns[h] = m.hour_samples[h] = m.hour_max_ns[h] = 0;
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        MetricShard& s = g_metric_shards[i];
+        m.calls += s.calls[metric].load(memory_order_relaxed);
+        m.total_ns += s.total_ns[metric].load(memory_order_relaxed);
+        m.max_ns = max(m.max_ns, s.max_ns[metric].load(memory_order_relaxed));
+        for (int b = 0; b < METRIC_BUCKETS; b++) {
+            unsigned int n = s.buckets[metric][b].load(memory_order_relaxed);
+            m.buckets[b] += n;
+            m.samples += n;
+        }
+        for (int h = 0; h < 24; h++) {
+            m.hour_calls[h] += s.hour_calls[metric][h].load(memory_order_relaxed);
+            m.hour_ns[h] += s.hour_ns[metric][h].load(memory_order_relaxed);
+            m.hour_samples[h] += s.hour_samples[metric][h].load(memory_order_relaxed);
+            m.hour_max_ns[h] = max(m.hour_max_ns[h], s.hour_max_ns[metric][h].load(memory_order_relaxed));
+        }
+    }
+    return m;
+}
+
+// ֱͼİٷλ룩
+unsigned long long metricPercentile(const MetricSummary& m, double p) {
+    if (m.samples == 0) return 0;
+    unsigned long long rank = (unsigned long long)(p * (m.samples - 1)) + 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < METRIC_BUCKETS; b++) {
+        seen += m.buckets[b];
+        if (seen >= rank) return min(metricBucketValue(b), m.max_ns);
+    }
+    return m.max_ns;
+}
+
+void resetMetrics() {
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        MetricShard& s = g_metric_shards[i];
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            s.calls[k].store(0, memory_order_relaxed);
+            s.total_ns[k].store(0, memory_order_relaxed);
+            s.max_ns[k].store(0, memory_order_relaxed);
+            for (int b = 0; b < METRIC_BUCKETS; b++) s.buckets[k][b].store(0, memory_order_relaxed);
+            for (int h = 0; h < 24; h++) {
+                s.hour_calls[k][h].store(0, memory_order_relaxed);
+                s.hour_ns[k][h].store(0, memory_order_relaxed);
+                s.hour_samples[k][h].store(0, memory_order_relaxed);
+                s.hour_max_ns[k][h].store(0, memory_order_relaxed);
+            }
+        }
+    }
+    g_metrics_since.store((long long)time(nullptr));
+}
+
+// ı棺ĵӳٷֲӵĵͺʱĲ߷ӵķϸ
+void dumpMetrics(ostream& out) {
+    vector<MetricSummary> all;
+    for (int k = 0; k < METRIC_COUNT; k++) all.push_back(collectMetric(k));
+
+    time_t since = (time_t)g_metrics_since.load();
+    char since_str[20];
+    strftime(since_str, sizeof(since_str), "%Y-%m-%d %H:%M:%S", localtime(&since));
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+
+    out << "==================== ϵͳָ ====================" << endl;
+    out << "ͳ㣺" << since_str << "ۼӣʱλ΢룩" << endl;
+    out << left << setw(24) << "" << right << setw(12) << "" << setw(9) << ""
+        << setw(10) << "ƽ" << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99"
+        << setw(10) << "p99.9" << setw(11) << "" << endl;
+    out << fixed << setprecision(2);
+    for (int k = 0; k < METRIC_COUNT; k++) {
+        const MetricSummary& m = all[k];
+        if (m.calls == 0) continue;
+        out << left << setw(24) << METRIC_INFO[k].name << right << setw(12) << m.calls
+            << setw(9) << m.samples
+            << setw(10) << m.total_ns / 1000.0 / m.samples
+            << setw(10) << metricPercentile(m, 0.50) / 1000.0
+            << setw(10) << metricPercentile(m, 0.90) / 1000.0
+            << setw(10) << metricPercentile(m, 0.99) / 1000.0
+            << setw(10) << metricPercentile(m, 0.999) / 1000.0
+            << setw(11) << m.max_ns / 1000.0 << endl;
+    }
+
+    // ӵܺʱ = ƽʱ  
+    out << "\nӵ㣺" << endl;
+    out << left << setw(6) << "ӵ" << right << setw(12) << "" << setw(14) << "ʱ(ms)"
+        << "  ʱĲ" << endl;
+    int peak_hour = -1;
+    unsigned long long peak_calls = 0;
+    for (int h = 0; h < 24; h++) {
+        unsigned long long calls = 0;
+        double hour_ms = 0.0, top_ms = -1.0;
+        int top = -1;
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            const MetricSummary& m = all[k];
+            if (m.hour_samples[h] == 0) continue;
+            double ms = (double)m.hour_ns[h] / m.hour_samples[h] * m.hour_calls[h] / 1e6;
+            calls += m.hour_calls[h];
+            hour_ms += ms;
+            if (ms > top_ms) {
+                top_ms = ms;
+                top = k;
+            }
+        }
+        if (calls == 0) continue;
+        if (calls > peak_calls) {
+            peak_calls = calls;
+            peak_hour = h;
+        }
+        out << left << setw(6) << (to_string(h) + "ʱ") << right << setw(12) << calls
+            << setw(14) << hour_ms << "  " << METRIC_INFO[top].name << endl;
+    }
+
+    if (peak_hour >= 0) {
+        out << "\n߷ӵ " << peak_hour << " ʱʱ򣩣" << endl;
+        out << left << setw(24) << "" << right << setw(12) << "" << setw(10) << "ƽ"
+            << setw(11) << "" << setw(14) << "ʱ(ms)" << endl;
+        vector<pair<double, int>> order;
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            const MetricSummary& m = all[k];
+            if (m.hour_samples[peak_hour] == 0) continue;
+            order.push_back(make_pair((double)m.hour_ns[peak_hour] / m.hour_samples[peak_hour] *
+                                      m.hour_calls[peak_hour] / 1e6, k));
+        }
+        sort(order.rbegin(), order.rend());
+        for (size_t i = 0; i < order.size(); i++) {
+            const MetricSummary& m = all[order[i].second];
+            out << left << setw(24) << METRIC_INFO[order[i].second].name << right
+                << setw(12) << m.hour_calls[peak_hour]
+                << setw(10) << m.hour_ns[peak_hour] / 1000.0 / m.hour_samples[peak_hour]
+                << setw(11) << m.hour_max_ns[peak_hour] / 1000.0
+                << setw(14) << order[i].first << endl;
+        }
+    }
+    out << "======================================================" << endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+int dumpMetricsToFile(const char *filename) {
+    ofstream file(filename, ios::out | ios::trunc);
+    if (!file) return -1;
+    dumpMetrics(file);
+    return file.good() ? 0 : -1;
+}
+
+void metricsMenu() {
+    system("cls");
+    dumpMetrics(cout);
+    cout << "\n1. " << METRIC_FILE << "  2. ͳ  0. ˵" << endl;
+    cout << "ѡ";
+    int subChoice;
+    cin >> subChoice;
+    cin.ignore(); // 
+
+    switch (subChoice) {
+        case 1:
+            if (dumpMetricsToFile(METRIC_FILE) == 0) {
+                cout << "ѵ " << METRIC_FILE << endl;
+            } else {
+                cout << "޷д " << METRIC_FILE << endl;
+            }
+            break;
+        case 2:
+            resetMetrics();
+            cout << "ָ" << endl;
+            break;
+        case 0: break;
+        default: cout << "Ч" << endl;
+    }
+}
+
+// ordered_list.h - ˳
+typedef struct {
+    Medicine *medicines;        // ҩƷ飨¼
+    MedicineColumns hot;        // ֶд
+    int length;                 // ǰ
+    int capacity;               // 
+    HashIndex id_index;         // ID -> ±
+    HashIndex name_index;       // 淶 -> ±
+    unsigned int journal_seq;   // ڿһˮ
+    WarningEngine *warnings;    // Ԥ
+    DailyStatsView *daily;      // ͳƣdaily_stats_view.h
+    StructureLock *lock;        // ƣinventory_lock.h
+} OrderedList;
+
+// ҵָ±slotҩƷ
+int findIdEntry(OrderedList *list, int id, int slot) {
+    return probeHashIndex(&list->id_index, hashMedicineId(id),
+                          [&](int s) { return s == slot; });
+}
+
+int findNameEntry(OrderedList *list, const char *name, int slot) {
+    char key[MAX_NAME_LEN];
+    normalizeMedicineName(name, key);
+    return probeHashIndex(&list->name_index, hashMedicineName(key),
+                          [&](int s) { return s == slot; });
+}
+
+// ±iҩƷ
+void indexAddMedicine(OrderedList *list, int i) {
+    char key[MAX_NAME_LEN];
+    normalizeMedicineName(list->medicines[i].name, key);
+    hashIndexInsert(&list->id_index, hashMedicineId(list->medicines[i].id), i);
+    hashIndexInsert(&list->name_index, hashMedicineName(key), i);
+}
+
+// ±iҩƷƳ
+void indexRemoveMedicine(OrderedList *list, int i) {
+    int pos = findIdEntry(list, list->medicines[i].id, i);
+    if (pos >= 0) hashIndexErase(&list->id_index, pos);
+    pos = findNameEntry(list, list->medicines[i].name, i);
+    if (pos >= 0) hashIndexErase(&list->name_index, pos);
+}
+
+// Ԫƶ[from, to]ڵҩƷԭ±Ϊ k - delta
+void indexShiftMedicines(OrderedList *list, int from, int to, int delta) {
+    // ʱӺǰʱǰ±ҵľ±
+    int step = delta > 0 ? -1 : 1;
+    int k = delta > 0 ? to : from;
+    for (; k >= from && k <= to; k += step) {
+        int pos = findIdEntry(list, list->medicines[k].id, k - delta);
+        if (pos >= 0) list->id_index.slots[pos] = k;
+        pos = findNameEntry(list, list->medicines[k].name, k - delta);
+        if (pos >= 0) list->name_index.slots[pos] = k;
+    }
+}
+
+// ҩƷ¼ֱ޸ĺֶͬ
+void syncMedicineColumns(OrderedList *list, const Medicine *med) {
+    storeMedicineColumns(&list->hot, med - list->medicines, med);
+}
+
+// ؽȫֶΣʹã
+void rebuildMedicineColumns(OrderedList *list) {
+    for (int i = 0; i < list->length; i++) {
+        storeMedicineColumns(&list->hot, i, &list->medicines[i]);
+    }
+}
+
+// ؽȫʹã
+void rebuildMedicineIndex(OrderedList *list) {
+    freeHashIndex(&list->id_index);
+    freeHashIndex(&list->name_index);
+    initHashIndex(&list->id_index, list->length);
+    initHashIndex(&list->name_index, list->length);
+    for (int i = 0; i < list->length; i++) {
+        indexAddMedicine(list, i);
+    }
+}
+
+// 
+OrderedList* createOrderedList(int capacity) {
+    if (capacity <= 0) capacity = 1;
+    OrderedList *list = new OrderedList;
+    list->medicines = new Medicine[capacity];
+    allocMedicineColumns(&list->hot, capacity);
+    list->length = 0;
+    list->capacity = capacity;
+    list->journal_seq = 0;
+    list->warnings = new WarningEngine;
+    list->daily = new DailyStatsView;
+    list->lock = new StructureLock;
+    initHashIndex(&list->id_index, capacity);
+    initHashIndex(&list->name_index, capacity);
+    return list;
+}
+
+// 
+void destroyOrderedList(OrderedList *list) {
+    if (list != nullptr) {
+        delete[] list->medicines;
+        freeMedicineColumns(&list->hot);
+        freeHashIndex(&list->id_index);
+        freeHashIndex(&list->name_index);
+        delete list->warnings;
+        delete list->daily;
+        delete list->lock;
+        delete list;
+    }
+}
+
+// ݣ2֤min_capacityҩƷ
+void reserveOrderedList(OrderedList *list, int min_capacity) {
+    if (list->capacity >= min_capacity) return;
+
+    int new_capacity = list->capacity;
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+
+    Medicine *new_medicines = new Medicine[new_capacity];
+    memcpy(new_medicines, list->medicines, sizeof(Medicine) * list->length);
+    delete[] list->medicines;
+    list->medicines = new_medicines;
+    list->capacity = new_capacity;
+
+    freeMedicineColumns(&list->hot);
+    allocMedicineColumns(&list->hot, new_capacity);
+    rebuildMedicineColumns(list);
+}
+
+// ֲҵһIDidλãλã
+int upperBoundMedicine(OrderedList *list, int id) {
+    int left = 0, right = list->length;
+    while (left < right) {
+        int mid = left + (right - left) / 2;
+        if (list->medicines[mid].id <= id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+// ϣҩƷ±꣬δҵ-1
+int findMedicineSlot(OrderedList *list, int id) {
+    int pos = probeHashIndex(&list->id_index, hashMedicineId(id),
+                             [&](int slot) { return list->hot.ids[slot] == id; });
+    return pos < 0 ? -1 : list->id_index.slots[pos];
+}
+
+// ϣҩƷO(1)ģ޹ء
+// صָҩƷɾʧЧֻ˵߳ʹã̰߳IDÿ
+Medicine* findMedicine(OrderedList *list, int id) {
+    MetricTimer timer(METRIC_FIND_MEDICINE);
+    int i = findMedicineSlot(list, id);
+    return i < 0 ? nullptr : &list->medicines[i];
+}
+
+// ƾȷңβհ׺ASCIIСдͬҩƷȫ
+int findMedicinesByName(OrderedList *list, const char *name, vector<Medicine*>& result) {
+    char key[MAX_NAME_LEN];
+    char other[MAX_NAME_LEN];
+    normalizeMedicineName(name, key);
+
+    const HashIndex *index = &list->name_index;
+    unsigned int hash = hashMedicineName(key);
+    unsigned int mask = index->capacity - 1;
+    int found = 0;
+    for (unsigned int i = hash & mask; index->slots[i] != INDEX_EMPTY; i = (i + 1) & mask) {
+        int slot = index->slots[i];
+        if (slot < 0 || index->hashes[i] != hash) continue;
+        normalizeMedicineName(list->medicines[slot].name, other);
+        if (strcmp(key, other) == 0) {
+            result.push_back(&list->medicines[slot]);
+            found++;
+        }
+    }
+    return found;
+}
+
+// ҩƷ
+int insertMedicine(OrderedList *list, Medicine med) {
+    StructureWriteGuard guard(list->lock);
+    if (list->length >= list->capacity) {
+        reserveOrderedList(list, list->length + 1);
+    }
+    
+    // ֲҲλ
+    int pos = upperBoundMedicine(list, med.id);
+    
+    // ƶԪ
+    memmove(&list->medicines[pos + 1], &list->medicines[pos],
+            sizeof(Medicine) * (list->length - pos));
+    moveMedicineColumns(&list->hot, pos + 1, pos, list->length - pos);
+    
+    list->medicines[pos] = med;
+    storeMedicineColumns(&list->hot, pos, &med);
+    list->length++;
+
+    indexShiftMedicines(list, pos + 1, list->length - 1, 1);
+    indexAddMedicine(list, pos);
+    markWarningDirty(list->warnings, med.id);
+    return 0;
+}
+
+// ҩƷȶٴβһι鲢
+int insertMedicines(OrderedList *list, const Medicine *meds, int count) {
+    if (list == nullptr || meds == nullptr || count <= 0) {
+        return 0;
+    }
+
+    vector<Medicine> batch(meds, meds + count);
+    stable_sort(batch.begin(), batch.end(), [](const Medicine& a, const Medicine& b) {
+        return a.id < b.id;
+    });
+
+    StructureWriteGuard guard(list->lock);
+
+    reserveOrderedList(list, list->length + count);
+
+    // Ӻǰ鲢ÿԪֻƶһ
+    int i = list->length - 1;   // ԭĩβ
+    int j = count - 1;          // ĩβ
+    int k = list->length + count - 1;
+    while (j >= 0) {
+        if (i >= 0 && list->medicines[i].id > batch[j].id) {
+            list->medicines[k--] = list->medicines[i--];
+        } else {
+            list->medicines[k--] = batch[j--];
+        }
+    }
+
+    list->length += count;
+    rebuildMedicineColumns(list);
+    rebuildMedicineIndex(list);
+    for (int b = 0; b < count; b++) {
+        markWarningDirty(list->warnings, batch[b].id);
+    }
+    return count;
+}
+
+// ɾҩƷ
+int deleteMedicine(OrderedList *list, int id) {
+    StructureWriteGuard guard(list->lock);
+    Medicine *med = findMedicine(list, id);
+    if (med == nullptr) {
+        return -1; // δҵ
+    }
+
+    // ǰƶԪ
+    int i = med - list->medicines;
+    indexRemoveMedicine(list, i);
+    memmove(&list->medicines[i], &list->medicines[i + 1],
+            sizeof(Medicine) * (list->length - i - 1));
+    moveMedicineColumns(&list->hot, i, i + 1, list->length - i - 1);
+    list->length--;
+
+    indexShiftMedicines(list, i, list->length - 1, -1);
+    markWarningDirty(list->warnings, id);
+    return 0;
+}
+
+// ҩƷϢID䣩Ʊ仯ʱͬ
+int updateMedicine(OrderedList *list, Medicine med) {
+    StructureWriteGuard guard(list->lock);
+    Medicine *old = findMedicine(list, med.id);
+    if (old == nullptr) {
+        return -1; // δҵ
+    }
+
+    int i = old - list->medicines;
+    if (strcmp(old->name, med.name) != 0) {
+        int pos = findNameEntry(list, old->name, i);
+        if (pos >= 0) hashIndexErase(&list->name_index, pos);
+
+        char key[MAX_NAME_LEN];
+        normalizeMedicineName(med.name, key);
+        hashIndexInsert(&list->name_index, hashMedicineName(key), i);
+    }
+    *old = med;
+    storeMedicineColumns(&list->hot, i, old);
+    markWarningDirty(list->warnings, med.id);
+    return 0;
+}
+
+// б䶯ͬ¼ԤֵʱŵǼֻ
+void stockChanged(OrderedList *list, int i, int old_stock, int delta) {
+    atomicAddInt(&list->medicines[i].stock, delta);
+    int threshold = list->hot.threshold[i];
+    if ((old_stock < threshold) != (old_stock + delta < threshold)) {
+        markWarningDirty(list->warnings, list->hot.ids[i]);
+    }
+}
+
+// ӿ棨ɶ̲߳ãCASӣʹ泬intʱܾ
+// quantityΪʱԭۼУ飨طų⡢˻Ԥ
+int increaseStock(OrderedList *list, int id, int quantity) {
+    StructureReadGuard guard(list->lock);
+    int i = findMedicineSlot(list, id);
+    if (i < 0) return -1; // δҵ
+    int *stock = &list->hot.stock[i];
+    int old_stock = atomicLoadInt(stock);
+    do {
+        if (quantity > 0 && old_stock > INT_MAX - quantity) return -2; // 
+    } while (!atomicCasInt(stock, &old_stock, old_stock + quantity));
+    stockChanged(list, i, old_stock, quantity);
+    return 0;
+}
+
+// ٿ棨ɶ̲߳ãCASۼ治ʱܾ
+int decreaseStock(OrderedList *list, int id, int quantity) {
+    StructureReadGuard guard(list->lock);
+    int i = findMedicineSlot(list, id);
+    if (i < 0) return -1; // δҵ
+    int *stock = &list->hot.stock[i];
+    int old_stock = atomicLoadInt(stock);
+    do {
+        if (old_stock < quantity) return -2; // 治
+    } while (!atomicCasInt(stock, &old_stock, old_stock - quantity));
+    stockChanged(list, i, old_stock, -quantity);
+    return 0;
+}
+
+// ϼƣֻ
+long long getTotalStock(OrderedList *list) {
+    StructureReadGuard guard(list->lock);
+    long long total = 0;
+    const int *stock = list->hot.stock;
+    for (int i = 0; i < list->length; i++) {
+        total += atomicLoadInt(&stock[i]);   // ߳̿ͬʱڸ
+    }
+    return total;
+}
+
+// ԤеҩƷֻԤ״̬
+int countWarningMedicines(OrderedList *list) {
+    StructureReadGuard guard(list->lock);
+    int count = 0;
+    const unsigned char *warning = list->hot.warning;
+    for (int i = 0; i < list->length; i++) {
+        count += warning[i] != 0;
+    }
+    return count;
+}
+
+// storage.h - ݳ־ûƼ¼ӳأԭӱ棩
+#define CATALOGUE_FILE "medicines.dat"
+#define CATALOGUE_MAGIC "TCMI"
+#define CATALOGUE_VERSION 2     // 2: ʷΪδ
+
+// ؽֻļʱܴӿտ濪ʼܸԭļ
+enum LoadStatus {
+    LOAD_OK = 0,
+    LOAD_MISSING,               // ļڣ״У
+    LOAD_CORRUPT,               // ļضϻУͲ
+    LOAD_UNSUPPORTED,           // 汾¼ֲ
+    LOAD_IO_ERROR               // ļڵ޷ȡ
+};
+
+// 汾1ҩƷ¼ʷΪ7̶λ[6]Ϊʱĵ
+typedef struct {
+    int id;
+    char name[MAX_NAME_LEN];
+    char origin[MAX_ORIGIN_LEN];
+    char spec[MAX_SPEC_LEN];
+    int stock;
+    int warning_threshold;
+    int last_usage;
+    int usage_history[HISTORY_DAYS];
+    int is_warning;
+    time_t warning_time;
+    time_t response_time;
+} MedicineV1;
+
+// ļͷcountMedicine¼
+typedef struct {
+    char magic[4];              // ļʶ "TCMI"
+    unsigned int version;       // ʽ汾
+    unsigned int record_size;   // ¼ֽṹ岼ֱ仯ʱܾأ
+    int count;                  // ¼
+    unsigned int checksum;      // ȫ¼У
+    unsigned int journal_seq;   // Ѱһˮ
+} CatalogueHeader;
+
+// ֻӳļ
+typedef struct {
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+int mapFileReadOnly(const char *filename, MappedFile *mf) {
+    mf->data = nullptr;
+    mf->size = 0;
+#ifdef _WIN32
+    mf->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mf->file == INVALID_HANDLE_VALUE) return -1;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mf->file, &size) || size.QuadPart == 0) {
+        CloseHandle(mf->file);
+        return -1;
+    }
+    mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf->mapping == NULL) {
+        CloseHandle(mf->file);
+        return -1;
+    }
+    mf->data = (const char*)MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mf->data == nullptr) {
+        CloseHandle(mf->mapping);
+        CloseHandle(mf->file);
+        return -1;
+    }
+    mf->size = (size_t)size.QuadPart;
+#else
+    mf->fd = open(filename, O_RDONLY);
+    if (mf->fd < 0) return -1;
+    struct stat st;
+    if (fstat(mf->fd, &st) != 0 || st.st_size == 0) {
+        close(mf->fd);
+        return -1;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, mf->fd, 0);
+    if (p == MAP_FAILED) {
+        close(mf->fd);
+        return -1;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    mf->data = (const char*)p;
+    mf->size = (size_t)st.st_size;
+#endif
+    return 0;
+}
+
+void unmapFile(MappedFile *mf) {
+    if (mf->data == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mf->data);
+    CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+#else
+    munmap((void*)mf->data, mf->size);
+    close(mf->fd);
+#endif
+    mf->data = nullptr;
+}
+
+// ļˢ
+int syncFile(FILE *fp) {
+    if (fflush(fp) != 0) return -1;
+#ifdef _WIN32
+    return _commit(_fileno(fp));
+#else
+    return fsync(fileno(fp));
+#endif
+}
+
+// fromԭ滻to
+int replaceFile(const char *from, const char *to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+#else
+    return rename(from, to);
+#endif
+}
+
+unsigned int checksumBytes(const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char*)data;
+    unsigned int h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// ͳͼдļдʱļ滻journal_seqΪͬʱĿ
+int saveDailyStats(DailyStatsView *view, const char *filename, unsigned int journal_seq) {
+    vector<DailyStatsRecord> records;
+    vector<DailyMedRecord> movements;
+    {
+        lock_guard<mutex> guard(view->lock);
+        records.reserve(view->days.size());
+        for (auto it = view->days.begin(); it != view->days.end(); ++it) {
+            const DailyAggregate& agg = it->second;
+            DailyStatsRecord rec = {it->first, agg.in_orders, agg.in_quantity, agg.responses, agg.response_hours};
+            records.push_back(rec);
+        }
+        for (auto day = view->meds.begin(); day != view->meds.end(); ++day) {
+            for (auto it = day->second.begin(); it != day->second.end(); ++it) {
+                DailyMedRecord rec = {day->first, it->first, it->second.in_quantity, it->second.out_quantity};
+                movements.push_back(rec);
+            }
+        }
+    }
+    sort(records.begin(), records.end(),
+         [](const DailyStatsRecord& a, const DailyStatsRecord& b) { return a.day < b.day; });
+    sort(movements.begin(), movements.end(), [](const DailyMedRecord& a, const DailyMedRecord& b) {
+        return a.day != b.day ? a.day < b.day : a.med_id < b.med_id;
+    });
+    string payload((const char*)records.data(), sizeof(DailyStatsRecord) * records.size());
+    payload.append((const char*)movements.data(), sizeof(DailyMedRecord) * movements.size());
+
+    DailyStatsHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DAILY_STATS_MAGIC, 4);
+    header.version = DAILY_STATS_VERSION;
+    header.journal_seq = journal_seq;
+    header.count = (int)records.size();
+    header.checksum = checksumBytes(payload.data(), payload.size());
+
+    string tmp_name = string(filename) + ".tmp";
+    FILE *fp = fopen(tmp_name.c_str(), "wb");
+    if (fp == nullptr) return -1;
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(payload.data(), 1, payload.size(), fp) == payload.size() &&
+              syncFile(fp) == 0;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || replaceFile(tmp_name.c_str(), filename) != 0) {
+        remove(tmp_name.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+// ͼļɹview->journal_seqΪļеţļȱʧ𻵷-1ͼΪա
+// 汾1ļûиҩƷ汾2ûгⲿִӿտʼ
+int loadDailyStats(DailyStatsView *view, const char *filename) {
+    MappedFile mf;
+    if (mapFileReadOnly(filename, &mf) != 0) return -1;
+    const DailyStatsHeader *header = (const DailyStatsHeader*)mf.data;
+    const char *payload = mf.data + sizeof(DailyStatsHeader);
+    size_t payload_size = mf.size - sizeof(DailyStatsHeader);
+    size_t summary_bytes = 0, med_size = sizeof(DailyMedRecord);
+    bool ok = mf.size >= sizeof(DailyStatsHeader) && memcmp(header->magic, DAILY_STATS_MAGIC, 4) == 0 &&
+              header->version >= 1 && header->version <= DAILY_STATS_VERSION && header->count >= 0;
+    if (ok) {
+        if (header->version == 2) med_size = sizeof(DailyInboundRecord);
+        summary_bytes = (size_t)header->count * sizeof(DailyStatsRecord);
+        ok = summary_bytes <= payload_size &&
+             (payload_size - summary_bytes) % med_size == 0 &&
+             (header->version > 1 || payload_size == summary_bytes) &&
+             header->checksum == checksumBytes(payload, payload_size);
+    }
+    if (!ok) {
+        unmapFile(&mf);
+        return -1;
+    }
+
+    const DailyStatsRecord *records = (const DailyStatsRecord*)payload;
+    const char *med_records = payload + summary_bytes;
+    size_t med_count = (payload_size - summary_bytes) / med_size;
+    {
+        lock_guard<mutex> guard(view->lock);
+        view->days.clear();
+        view->meds.clear();
+        for (int i = 0; i < header->count; i++) {
+            DailyAggregate& agg = view->days[records[i].day];
+            agg.in_orders = records[i].in_orders;
+            agg.in_quantity = records[i].in_quantity;
+            agg.responses = records[i].responses;
+            agg.response_hours = records[i].response_hours;
+        }
+        for (size_t i = 0; i < med_count; i++) {
+            if (header->version == 2) {
+                const DailyInboundRecord *rec = (const DailyInboundRecord*)med_records + i;
+                view->meds[rec->day][rec->med_id].in_quantity = rec->quantity;
+            } else {
+                const DailyMedRecord *rec = (const DailyMedRecord*)med_records + i;
+                MedDayMovement& movement = view->meds[rec->day][rec->med_id];
+                movement.in_quantity = rec->in_quantity;
+                movement.out_quantity = rec->out_quantity;
+            }
+        }
+        view->journal_seq = header->journal_seq;
+    }
+    unmapFile(&mf);
+    return 0;
+}
+
+// Ǽǹ䶯ҩƷwarning_logic.h֣
+int evaluateDirtyWarnings(OrderedList *inventory, time_t now);
+
+// 浽ļдʱļ̣ٸ滻;ԭļ
+// ǰԤеԤ״̬һ£ͳͼд<filename>.daily
+int saveToFile(OrderedList *list, const char *filename) {
+    if (list == nullptr || filename == nullptr) return -1;
+    StructureWriteGuard guard(list->lock);     // ų⣬õһ¿
+    evaluateDirtyWarnings(list, time(NULL));
+
+    string tmp_name = string(filename) + ".tmp";
+    FILE *fp = fopen(tmp_name.c_str(), "wb");
+    if (fp == nullptr) return -1;
+
+    CatalogueHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CATALOGUE_MAGIC, 4);
+    header.version = CATALOGUE_VERSION;
+    header.record_size = sizeof(Medicine);
+    header.count = list->length;
+    header.checksum = checksumBytes(list->medicines, sizeof(Medicine) * list->length);
+    header.journal_seq = list->journal_seq;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              (list->length == 0 ||
+               fwrite(list->medicines, sizeof(Medicine), list->length, fp) == (size_t)list->length) &&
+              syncFile(fp) == 0;
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || replaceFile(tmp_name.c_str(), filename) != 0) {
+        remove(tmp_name.c_str());
+        return -1;
+    }
+    // ͼڿ֮д룬ͼŲᳬţθ֮ʱͼˮⲿ
+    string daily_name = string(filename) + DAILY_STATS_SUFFIX;
+    return saveDailyStats(list->daily, daily_name.c_str(), list->journal_seq);
+}
+
+// 汾1¼תΪǰʽλļ޸ڵƵ
+void migrateMedicineV1(const MedicineV1 *old, Medicine *med, DayId saved_day) {
+    memset(med, 0, sizeof(Medicine));
+    med->id = old->id;
+    memcpy(med->name, old->name, sizeof(med->name));
+    memcpy(med->origin, old->origin, sizeof(med->origin));
+    memcpy(med->spec, old->spec, sizeof(med->spec));
+    med->stock = old->stock;
+    med->warning_threshold = old->warning_threshold;
+    med->last_usage = old->last_usage;
+    med->is_warning = old->is_warning;
+    med->warning_time = old->warning_time;
+    med->response_time = old->response_time;
+    med->usage_history.last_day = saved_day - (HISTORY_DAYS - 1);
+    for (int k = 0; k < HISTORY_DAYS; k++) {
+        recordUsageOnDay(med, saved_day - (HISTORY_DAYS - 1 - k), old->usage_history[k]);
+    }
+}
+
+// ļأӳļУļͷһԿȫ¼汾1ļת
+// *statusʧԭ򣬵÷ֻLOAD_MISSINGʱſԴӿտ濪ʼ
+OrderedList* loadFromFile(const char *filename, LoadStatus *status) {
+    struct stat st;
+    if (stat(filename, &st) != 0) {
+        *status = errno == ENOENT ? LOAD_MISSING : LOAD_IO_ERROR;
+        return nullptr;
+    }
+    MappedFile mf;
+    if (mapFileReadOnly(filename, &mf) != 0) {
+        *status = st.st_size == 0 ? LOAD_CORRUPT : LOAD_IO_ERROR;
+        return nullptr;
+    }
+
+    OrderedList *list = nullptr;
+    const CatalogueHeader *header = (const CatalogueHeader*)mf.data;
+    const char *records = mf.data + sizeof(CatalogueHeader);
+    size_t record_size = 0;
+
+    if (mf.size < sizeof(CatalogueHeader) || memcmp(header->magic, CATALOGUE_MAGIC, 4) != 0) {
+        *status = LOAD_CORRUPT;
+    } else if (header->version == CATALOGUE_VERSION && header->record_size == sizeof(Medicine)) {
+        record_size = sizeof(Medicine);
+    } else if (header->version == 1 && header->record_size == sizeof(MedicineV1)) {
+        record_size = sizeof(MedicineV1);
+    } else {
+        *status = LOAD_UNSUPPORTED;
+    }
+    if (record_size != 0 &&
+        (header->count < 0 ||
+         mf.size - sizeof(CatalogueHeader) != (size_t)header->count * record_size ||
+         header->checksum != checksumBytes(records, (size_t)header->count * record_size))) {
+        *status = LOAD_CORRUPT;
+        record_size = 0;
+    }
+
+    if (record_size != 0) {
+        list = createOrderedList(max(header->count, MAX_MEDICINES));
+        if (header->version == CATALOGUE_VERSION) {
+            memcpy(list->medicines, records, (size_t)header->count * sizeof(Medicine));
+        } else {
+            char saved_date[11];
+            strftime(saved_date, sizeof(saved_date), "%Y-%m-%d", localtime(&st.st_mtime));
+            const MedicineV1 *old = (const MedicineV1*)records;
+            for (int i = 0; i < header->count; i++) {
+                migrateMedicineV1(&old[i], &list->medicines[i], dateToDayNumber(saved_date));
+            }
+            cout << "ʾ" << filename << " Ϊ汾1ʽת " << header->count
+                 << " ¼´αʱдΪ汾" << CATALOGUE_VERSION << endl;
+        }
+        list->length = header->count;
+        list->journal_seq = header->journal_seq;
+        rebuildMedicineColumns(list);
+        rebuildMedicineIndex(list);
+        for (int i = 0; i < list->length; i++) {
+            markWarningDirty(list->warnings, list->medicines[i].id);
+        }
+        // ͳͼȱʧʱӿͼʼطˮֻܲⲿ
+        string daily_name = string(filename) + DAILY_STATS_SUFFIX;
+        if (loadDailyStats(list->daily, daily_name.c_str()) != 0 && header->journal_seq > 0) {
+            cout << "棺ͳļ " << daily_name << " ȱʧ𻵣ʷԤӦʱ佫ӿտʼͳ" << endl;
+        }
+    }
+
+    unmapFile(&mf);
+    if (list != nullptr) *status = LOAD_OK;
+    return list;
+}
+
+// circular_queue.h - ѭ
+typedef struct {
+    InOrder *orders;            // 
+    int front;                  // ͷָ
+    int rear;                   // βָ
+    int capacity;               // 
+    int size;                   // ǰС
+    mutex lock;                 // Ǽ߳ȡ⣨enqueue/dequeue
+} CircularQueue;
+
+// ѭ
+CircularQueue* createQueue(int capacity) {
+    CircularQueue* queue = new CircularQueue;
+    queue->orders = new InOrder[capacity];
+    queue->front = 0;
+    queue->rear = 0;
+    queue->size = 0;
+    queue->capacity = capacity;
+    return queue;
+}
+
+// ٶ
+void destroyQueue(CircularQueue *queue) {
+    if (queue != nullptr) {
+        delete[] queue->orders;
+        delete queue;
+    }
+}
+
+// 
+bool enqueue(CircularQueue *queue, InOrder order) {
+    MetricTimer timer(METRIC_ENQUEUE);
+    if (queue->size == queue->capacity) {
+        return false; // 
+    }
+    queue->orders[queue->rear] = order;
+    queue->rear = (queue->rear + 1) % queue->capacity;
+    queue->size++;
+    return true;
+}
+
+// 
+bool dequeue(CircularQueue *queue, InOrder *order) {
+    MetricTimer timer(METRIC_DEQUEUE);
+    if (queue->size == 0) {
+        return false; // п
+    }
+    *order = queue->orders[queue->front];
+    queue->front = (queue->front + 1) % queue->capacity;
+    queue->size--;
+    return true;
+}
+
+// ӣλ鿽سӸ
+int dequeueBatch(CircularQueue *queue, InOrder *orders, int max_count) {
+    int n = min(max_count, queue->size);
+    int first = min(n, queue->capacity - queue->front);
+    memcpy(orders, &queue->orders[queue->front], sizeof(InOrder) * first);
+    memcpy(orders + first, queue->orders, sizeof(InOrder) * (n - first));
+    queue->front = (queue->front + n) % queue->capacity;
+    queue->size -= n;
+    return n;
+}
+
+// ȡⵥʱʹãǼ̲߳ӣ
+int takeAllInOrders(CircularQueue *queue, vector<InOrder>& orders) {
+    lock_guard<mutex> guard(queue->lock);
+    orders.resize(queue->size);
+    return dequeueBatch(queue, orders.data(), queue->size);
+}
+
+// mpsc_queue.h - ߵУջնˣһ̣߳
+// ÿ۶ռһУseqǲ۵״̬
+// seq == pos д룬seq == pos + 1 ɶ
+struct alignas(CACHE_LINE_SIZE) MpscCell {
+    atomic<size_t> seq;
+    InOrder order;
+};
+
+class MpscInQueue {
+private:
+    MpscCell* cells;                                // λ
+    size_t mask;                                    //  - 1Ϊ2ݣ
+    alignas(CACHE_LINE_SIZE) atomic<size_t> tail;   // ߾дλ
+    alignas(CACHE_LINE_SIZE) size_t head;           // ߷ʵĶλ
+    char pad[CACHE_LINE_SIZE - sizeof(size_t)];     // ڶα
+    
+public:
+    MpscInQueue(int capacity) : tail(0), head(0) {
+        size_t cap = 2;
+        while (cap < (size_t)capacity) {
+            cap *= 2;
+        }
+        cells = new MpscCell[cap];
+        for (size_t i = 0; i < cap; i++) {
+            cells[i].seq.store(i, memory_order_relaxed);
+        }
+        mask = cap - 1;
+    }
+    ~MpscInQueue() { delete[] cells; }
+    
+    MpscInQueue(const MpscInQueue&) = delete;
+    MpscInQueue& operator=(const MpscInQueue&) = delete;
+    
+    int getCapacity() const { return (int)(mask + 1); }
+    
+    // ӣ̣߳false
+    bool enqueue(const InOrder& order) {
+        size_t pos = tail.load(memory_order_relaxed);
+        MpscCell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 
+            } else {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+        cell->order = order;
+        cell->seq.store(pos + 1, memory_order_release);
+        return true;
+    }
+    
+    // ӣ̣߳ȡĶ
+    int dequeueBatch(InOrder* out, int max_count) {
+        int n = 0;
+        while (n < max_count) {
+            MpscCell* cell = &cells[head & mask];
+            if (cell->seq.load(memory_order_acquire) != head + 1) break; // пջδд
+            out[n++] = cell->order;
+            cell->seq.store(head + mask + 1, memory_order_release);
+            head++;
+        }
+        return n;
+    }
+};
+
+// system_log.h - ṹ첽־ҵֻ߳Ѽ¼дλ壬̨߳дJSON
+#define LOG_FILE "system.log"
+#define LOG_RING_SIZE 4096          // λ2ݣ
+#define LOG_MESSAGE_LEN 192
+#define LOG_COMPONENT_LEN 16
+
+enum LogLevel { LOG_DEBUG = 0, LOG_INFO, LOG_WARN, LOG_ERROR };
+
+const char *LOG_LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+// ڲıΪGBK־ļHTTPӿһUTF-8ת̸߳һiconv̹ܿ߳ã
+void convertText(bool to_utf8, const char *src, size_t len, string& out) {
+    out.clear();
+    if (len == 0) return;
+#ifdef _WIN32
+    int from_cp = to_utf8 ? 936 : CP_UTF8;
+    int to_cp = to_utf8 ? CP_UTF8 : 936;
+    int wlen = MultiByteToWideChar(from_cp, 0, src, (int)len, nullptr, 0);
+    vector<wchar_t> wide(wlen > 0 ? wlen : 1);
+    wlen = MultiByteToWideChar(from_cp, 0, src, (int)len, wide.data(), wlen);
+    int n = WideCharToMultiByte(to_cp, 0, wide.data(), wlen, nullptr, 0, NULL, NULL);
+    if (n <= 0) return;
+    out.resize(n);
+    WideCharToMultiByte(to_cp, 0, wide.data(), wlen, &out[0], n, NULL, NULL);
+#else
+    static thread_local iconv_t to_utf8_cd = iconv_open("UTF-8", "GBK");
+    static thread_local iconv_t to_gbk_cd = iconv_open("GBK", "UTF-8");
+    iconv_t cd = to_utf8 ? to_utf8_cd : to_gbk_cd;
+    if (cd == (iconv_t)-1) {
+        out.assign(src, len);
+        return;
+    }
+    out.resize(len * 2 + 4);
+    char *in = const_cast<char*>(src);
+    char *dst = &out[0];
+    size_t out_left = out.size();
+    iconv(cd, nullptr, nullptr, nullptr, nullptr);
+    while (len > 0 && iconv(cd, &in, &len, &dst, &out_left) == (size_t)-1 && errno == EILSEQ) {
+        in++;                   // ޷תֽ
+        len--;
+    }
+    out.resize(out.size() - out_left);
+#endif
+}
+
+typedef struct {
+    long long time_ms;                  // ¼ʱ䣨ʱ
+    int level;                          // ־
+    char component[LOG_COMPONENT_LEN];  // ģ
+    char message[LOG_MESSAGE_LEN];      // ݣضϣ
+} LogRecord;
+
+struct alignas(CACHE_LINE_SIZE) LogCell {
+    atomic<size_t> seq;
+    LogRecord record;
+};
+
+// ͬĲЭ飻ʱҵ̴߳Ӳȴ
+class AsyncLogger {
+private:
+    LogCell* cells;
+    size_t mask;
+    alignas(CACHE_LINE_SIZE) atomic<size_t> tail;   // ߾дλ
+    alignas(CACHE_LINE_SIZE) size_t head;           // д̷߳ʵĶλ
+    atomic<bool> running;
+    atomic<int> min_level;
+    atomic<unsigned long long> dropped;             // 򻺳
+    FILE* fp;
+    thread writer;
+    string utf8;                                    // д̵߳ת
+
+    // ȡһ¼дJSONУ
+    int drain() {
+        int n = 0;
+        while (true) {
+            LogCell* cell = &cells[head & mask];
+            if (cell->seq.load(memory_order_acquire) != head + 1) break;
+            writeRecord(&cell->record);
+            cell->seq.store(head + mask + 1, memory_order_release);
+            head++;
+            n++;
+        }
+        unsigned long long lost = dropped.exchange(0, memory_order_relaxed);
+        if (lost > 0) {
+            LogRecord r;
+            r.time_ms = chrono::duration_cast<chrono::milliseconds>(
+                chrono::system_clock::now().time_since_epoch()).count();
+            r.level = LOG_WARN;
+            strcpy(r.component, "log");
+            snprintf(r.message, sizeof(r.message), "dropped %llu records", lost);
+            writeRecord(&r);
+        }
+        if (n > 0 || lost > 0) fflush(fp);
+        return n;
+    }
+
+    void writeRecord(const LogRecord* r) {
+        time_t seconds = (time_t)(r->time_ms / 1000);
+        char stamp[24];
+        tm local;
+        toLocalTime(seconds, &local);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &local);
+        fprintf(fp, "{\"ts\":\"%s.%03d\",\"level\":\"%s\",\"component\":\"", stamp,
+                (int)(r->time_ms % 1000), LOG_LEVEL_NAMES[r->level]);
+        writeEscaped(r->component);
+        fputs("\",\"msg\":\"", fp);
+        writeEscaped(r->message);
+        fputs("\"}\n", fp);
+    }
+
+    // GBKתUTF-8JSONַתд
+    void writeEscaped(const char* gbk) {
+        convertText(true, gbk, strlen(gbk), utf8);
+        for (size_t i = 0; i < utf8.size(); i++) {
+            unsigned char c = (unsigned char)utf8[i];
+            if (c == '"' || c == '\\') {
+                fputc('\\', fp);
+                fputc(c, fp);
+            } else if (c < 0x20) {
+                fprintf(fp, "\\u%04x", c);
+            } else {
+                fputc(c, fp);
+            }
+        }
+    }
+
+    void writerLoop() {
+        while (running.load(memory_order_acquire)) {
+            if (drain() == 0) {
+                this_thread::sleep_for(chrono::milliseconds(10));
+            }
+        }
+        drain();
+    }
+
+public:
+    AsyncLogger() : tail(0), head(0), running(false), min_level(LOG_INFO), dropped(0), fp(nullptr) {
+        cells = new LogCell[LOG_RING_SIZE];
+        for (size_t i = 0; i < LOG_RING_SIZE; i++) {
+            cells[i].seq.store(i, memory_order_relaxed);
+        }
+        mask = LOG_RING_SIZE - 1;
+    }
+    ~AsyncLogger() {
+        stop();
+        delete[] cells;
+    }
+
+    bool start(const char* filename, int level) {
+        if (running.load()) return true;
+        fp = fopen(filename, "a");
+        if (fp == nullptr) return false;
+        setvbuf(fp, nullptr, _IOFBF, 64 * 1024);
+        min_level.store(level);
+        running.store(true, memory_order_release);
+        writer = thread(&AsyncLogger::writerLoop, this);
+        return true;
+    }
+
+    // ֹͣд̣߳ʣļ¼ȫд
+    void stop() {
+        if (!running.exchange(false)) return;
+        writer.join();
+        fclose(fp);
+        fp = nullptr;
+    }
+
+    void setLevel(int level) { min_level.store(level, memory_order_relaxed); }
+
+    // һ־̣߳δͻ򻺳ʱֱӷ
+    void write(int level, const char* component, const char* fmt, va_list args) {
+        if (level < min_level.load(memory_order_relaxed) || !running.load(memory_order_relaxed)) return;
+
+        size_t pos = tail.load(memory_order_relaxed);
+        LogCell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, memory_order_relaxed);
+                return;
+            } else {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+
+        LogRecord* r = &cell->record;
+        r->time_ms = chrono::duration_cast<chrono::milliseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+        r->level = level;
+        strncpy(r->component, component, LOG_COMPONENT_LEN - 1);
+        r->component[LOG_COMPONENT_LEN - 1] = '\0';
+        vsnprintf(r->message, LOG_MESSAGE_LEN, fmt, args);
+        cell->seq.store(pos + 1, memory_order_release);
+    }
+};
+
+AsyncLogger g_logger;
+
+bool startSystemLog(const char *filename, int min_level) {
+    return g_logger.start(filename, min_level);
+}
+
+void stopSystemLog() {
+    g_logger.stop();
+}
+
+// ʽ־÷ͬprintf
+void logEvent(int level, const char *component, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    g_logger.write(level, component, fmt, args);
+    va_end(args);
+}
+
+void systemLog(const char *message) {
+    logEvent(LOG_INFO, "system", "%s", message);
+}
+
+// history_archive.h - ʷ鵵ĳⵥΪֻдֶļ
+// ѯʱӳļֻõУڴֻڵĳⵥ
+#define HISTORY_MANIFEST "history.idx"     // ֶ嵥ıÿһֶΣ
+#define HISTORY_MAGIC "TCMH"
+#define HISTORY_VERSION 2                   // 2: еУ飬״ζȡʱУ
+#define HISTORY_HOT_DAYS 30                 // ڴб죩
+#define HISTORY_CACHE_DAYS 64               // ѽĹ鵵ջ໺
+
+enum HistoryColumn {
+    HISTORY_COL_DAYS = 0,       // ʣ
+    HISTORY_COL_MED,            // ҩƷIDÿһ䳤
+    HISTORY_COL_QTY,            // ÿһ䳤
+    HISTORY_COL_RX,             // ţͬĺϲΪһΣǰһιǰ׺
+    HISTORY_COL_SUMMARY,        // ÿոҩƷĳ͵IDID֣
+    HISTORY_COLUMNS
+};
+
+// ֶļͷӸ
+typedef struct {
+    char magic[4];              // ļʶ "TCMH"
+    unsigned int version;
+    DayId first_day;            // ǵڷΧˣ
+    DayId last_day;
+    int row_count;              // ⵥ
+    unsigned int checksum;      // 汾1ļͷ֮ȫֽڵУͣ汾2
+    unsigned int col_offset[HISTORY_COLUMNS];   // ļͷƫ
+    unsigned int col_bytes[HISTORY_COLUMNS];
+    unsigned int col_checksum[HISTORY_COLUMNS]; // еУͣ汾2𣬰汾1ļͷΪֹ
+} HistorySegmentHeader;
+
+// ոݵʼƫƣף
+typedef struct {
+    int rows;                   // ճⵥ
+    int total_quantity;         // ճ
+    int med_count;              // ճҩƷ
+    unsigned int med_off;
+    unsigned int qty_off;
+    unsigned int rx_off;
+    unsigned int summary_off;
+} HistoryDayEntry;
+
+typedef struct {
+    int med_id;
+    int quantity;
+    int count;
+} ArchivedMedTotal;
+
+void appendVarint(string& out, unsigned int v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+inline unsigned int readVarint(const unsigned char *&p) {
+    unsigned int v = 0;
+    for (int shift = 0; ; shift += 7) {
+        unsigned char b = *p++;
+        v |= (unsigned int)(b & 0x7F) << shift;
+        if (b < 0x80) return v;
+    }
+}
+
+// תΪ"YYYY-MM-DD"dateToDayNumber㣩
+void formatDayNumber(DayId day, char *date) {
+    int z = day + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int d = doy - (153 * mp + 2) / 5 + 1;
+    int m = mp < 10 ? mp + 3 : mp - 9;
+    sprintf(date, "%04d-%02d-%02d", yoe + era * 400 + (m <= 2), m, d);
+}
+
+enum { COLUMN_UNCHECKED = 0, COLUMN_OK, COLUMN_BAD };
+
+struct HistorySegment {
+    DayId first_day;
+    DayId last_day;
+    int rows;
+    string filename;
+    MappedFile file;
+    const HistorySegmentHeader *header;
+    size_t header_size;                             // 汾ͬ
+    mutable unsigned char checked[HISTORY_COLUMNS]; // У״̬״ζȡʱУ
+
+    const unsigned char* column(int col) const {
+        return (const unsigned char*)file.data + header_size + header->col_offset[col];
+    }
+    const HistoryDayEntry* dayEntry(DayId day) const {
+        return (const HistoryDayEntry*)column(HISTORY_COL_DAYS) + (day - first_day);
+    }
+    
+    // ȡ֮ǰã״ζȡʱУУֻеҳ棩𻵵м־ٶȡ
+    bool columnReadable(int col) const {
+        if (checked[col] == COLUMN_UNCHECKED) {
+            bool ok = header->col_checksum[col] == checksumBytes(column(col), header->col_bytes[col]);
+            checked[col] = ok ? COLUMN_OK : COLUMN_BAD;
+            if (!ok) logEvent(LOG_ERROR, "history", "segment %s column %d checksum mismatch", filename.c_str(), col);
+        }
+        return checked[col] == COLUMN_OK;
+    }
+};
+
+class HistoryArchive {
+private:
+    string manifest;                    // Ϊձʾδù鵵
+    vector<HistorySegment> segments;    // Ⱥ
+    DayId sealed_through;               // ѷһ
+    int next_seq;                       // һֶļţ嵥гֹȫţ
+
+    // ӳֶļļͷ͸зΧУ״ζȡʱٲ飬
+    // ʱݡ汾1ļûзУͣڴʱУ
+    bool mapSegment(HistorySegment& seg) {
+        if (mapFileReadOnly(seg.filename.c_str(), &seg.file) != 0) return false;
+        const HistorySegmentHeader *h = (const HistorySegmentHeader*)seg.file.data;
+        size_t v1_size = offsetof(HistorySegmentHeader, col_checksum);
+        bool ok = seg.file.size >= v1_size && memcmp(h->magic, HISTORY_MAGIC, 4) == 0 &&
+                  (h->version == 1 || (h->version == HISTORY_VERSION && seg.file.size >= sizeof(HistorySegmentHeader)));
+        seg.header_size = ok && h->version == 1 ? v1_size : sizeof(HistorySegmentHeader);
+        size_t payload = ok ? seg.file.size - seg.header_size : 0;
+        ok = ok && h->first_day == seg.first_day && h->last_day == seg.last_day &&
+             h->col_bytes[HISTORY_COL_DAYS] == (h->last_day - h->first_day + 1) * sizeof(HistoryDayEntry);
+        for (int c = 0; ok && c < HISTORY_COLUMNS; c++) {
+            ok = (size_t)h->col_offset[c] + h->col_bytes[c] <= payload;
+        }
+        if (ok && h->version == 1) {
+            ok = h->checksum == checksumBytes(seg.file.data + seg.header_size, payload);
+        }
+        if (!ok) {
+            unmapFile(&seg.file);
+            return false;
+        }
+        seg.header = h;
+        seg.rows = h->row_count;
+        memset(seg.checked, h->version == 1 ? COLUMN_OK : COLUMN_UNCHECKED, sizeof(seg.checked));
+        return true;
+    }
+    
+    // ֶļĩβţhistory_<>_<ֹ>_<>.seg
+    static int segmentSeq(const string& filename) {
+        size_t pos = filename.rfind('_');
+        return pos == string::npos ? 0 : atoi(filename.c_str() + pos + 1);
+    }
+
+    int saveManifest() {
+        string tmp = manifest + ".tmp";
+        FILE *fp = fopen(tmp.c_str(), "w");
+        if (fp == nullptr) return -1;
+        fprintf(fp, "%s %d\n", HISTORY_MAGIC, HISTORY_VERSION);
+        for (size_t i = 0; i < segments.size(); i++) {
+            fprintf(fp, "%d %d %d %s\n", segments[i].first_day, segments[i].last_day,
+                    segments[i].rows, segments[i].filename.c_str());
+        }
+        if (syncFile(fp) != 0) {
+            fclose(fp);
+            return -1;
+        }
+        fclose(fp);
+        return replaceFile(tmp.c_str(), manifest.c_str());
+    }
+
+public:
+    HistoryArchive() : sealed_through(INT_MIN), next_seq(1) {}
+    ~HistoryArchive() { close(); }
+
+    // ֶ嵥ӳֶΣ嵥Ϊչ鵵0ɹ-1зֶ޷ȡ
+    int open(const char *manifest_file) {
+        close();
+        manifest = manifest_file;
+        FILE *fp = fopen(manifest_file, "r");
+        if (fp == nullptr) return 0;
+
+        int result = 0;
+        char magic[8] = {0}, name[256];
+        int version = 0;
+        if (fscanf(fp, "%7s %d", magic, &version) != 2 || strcmp(magic, HISTORY_MAGIC) != 0 ||
+            version < 1 || version > HISTORY_VERSION) {       // 嵥ʽ汾ͬɰֶԿɶ
+            fclose(fp);
+            return -1;
+        }
+        HistorySegment seg;
+        while (fscanf(fp, "%d %d %d %255s", &seg.first_day, &seg.last_day, &seg.rows, name) == 4) {
+            seg.filename = name;
+            next_seq = max(next_seq, segmentSeq(seg.filename) + 1);     // ķֶҲռ
+            if (!mapSegment(seg)) {
+                logEvent(LOG_ERROR, "history", "segment %s unreadable, skipped", name);
+                result = -1;
+                continue;
+            }
+            segments.push_back(seg);
+            sealed_through = max(sealed_through, seg.last_day);
+        }
+        fclose(fp);
+        return result;
+    }
+
+    void close() {
+        for (size_t i = 0; i < segments.size(); i++) unmapFile(&segments[i].file);
+        segments.clear();
+        manifest.clear();
+        sealed_through = INT_MIN;
+        next_seq = 1;
+    }
+
+    bool isOpen() const { return !manifest.empty(); }
+    DayId sealedThrough() const { return sealed_through; }
+    int segmentCount() const { return (int)segments.size(); }
+
+    bool covers(DayId day) const {
+        if (day > sealed_through) return false;
+        for (size_t i = 0; i < segments.size(); i++) {
+            if (segments[i].first_day <= day && day <= segments[i].last_day) return true;
+        }
+        return false;
+    }
+
+    long long totalRows() const {
+        long long n = 0;
+        for (size_t i = 0; i < segments.size(); i++) n += segments[i].rows;
+        return n;
+    }
+
+    long long totalBytes() const {
+        long long n = 0;
+        for (size_t i = 0; i < segments.size(); i++) n += (long long)segments[i].file.size;
+        return n;
+    }
+
+    // ĳյĻܣֻͻСصճⵥ
+    int readDaySummary(DayId day, vector<ArchivedMedTotal>& meds, int *total_quantity) const {
+        int rows = 0;
+        *total_quantity = 0;
+        for (size_t i = 0; i < segments.size(); i++) {
+            const HistorySegment& seg = segments[i];
+            if (day < seg.first_day || day > seg.last_day) continue;
+            if (!seg.columnReadable(HISTORY_COL_DAYS) || !seg.columnReadable(HISTORY_COL_SUMMARY)) continue;
+            const HistoryDayEntry *entry = seg.dayEntry(day);
+            const unsigned char *p = seg.column(HISTORY_COL_SUMMARY) + entry->summary_off;
+            int id = 0;
+            for (int k = 0; k < entry->med_count; k++) {
+                ArchivedMedTotal item;
+                id += (int)readVarint(p);
+                item.med_id = id;
+                item.quantity = (int)readVarint(p);
+                item.count = (int)readVarint(p);
+                meds.push_back(item);
+            }
+            rows += entry->rows;
+            *total_quantity += entry->total_quantity;
+        }
+        return rows;
+    }
+
+    // ĳյȫⵥջ˳򣩣ҩƷ
+    void readDayOrders(DayId day, vector<OutOrderNode>& orders) const {
+        char date[11];
+        formatDayNumber(day, date);
+        for (size_t i = 0; i < segments.size(); i++) {
+            const HistorySegment& seg = segments[i];
+            if (day < seg.first_day || day > seg.last_day) continue;
+            if (!seg.columnReadable(HISTORY_COL_DAYS) || !seg.columnReadable(HISTORY_COL_MED) ||
+                !seg.columnReadable(HISTORY_COL_QTY) || !seg.columnReadable(HISTORY_COL_RX)) continue;
+            const HistoryDayEntry *entry = seg.dayEntry(day);
+            const unsigned char *med = seg.column(HISTORY_COL_MED) + entry->med_off;
+            const unsigned char *qty = seg.column(HISTORY_COL_QTY) + entry->qty_off;
+            const unsigned char *rx = seg.column(HISTORY_COL_RX) + entry->rx_off;
+
+            char prescription_no[30] = {0};
+            int run = 0;
+            for (int k = 0; k < entry->rows; k++) {
+                if (run == 0) {
+                    run = (int)readVarint(rx);
+                    unsigned int shared = readVarint(rx);
+                    unsigned int suffix = readVarint(rx);
+                    memcpy(prescription_no + shared, rx, suffix);
+                    prescription_no[shared + suffix] = '\0';
+                    rx += suffix;
+                }
+                run--;
+
+                OutOrderNode order;
+                memset(&order, 0, sizeof(order));
+                order.med_id = (int)readVarint(med);
+                order.quantity = (int)readVarint(qty);
+                strcpy(order.prescription_no, prescription_no);
+                strcpy(order.date, date);
+                order.day = day;
+                orders.push_back(order);
+            }
+        }
+    }
+
+    // һⵥͬհջ˳򣩷Ϊ·ֶΣ[first_day, last_day]
+    // дʱļ̣ٸ嵥0ɹ-1ʧܣ鵵䣩
+    int seal(const vector<const OutOrderNode*>& rows, DayId first_day, DayId last_day) {
+        if (!isOpen() || rows.empty() || first_day > last_day) return -1;
+
+        int day_count = last_day - first_day + 1;
+        vector<HistoryDayEntry> entries(day_count);
+        memset(entries.data(), 0, sizeof(HistoryDayEntry) * day_count);
+        string med_col, qty_col, rx_col, summary_col;
+        map<int, pair<int, int>> totals;    // ոҩƷ (, )
+
+        size_t r = 0;
+        for (int d = 0; d < day_count; d++) {
+            HistoryDayEntry& entry = entries[d];
+            entry.med_off = (unsigned int)med_col.size();
+            entry.qty_off = (unsigned int)qty_col.size();
+            entry.rx_off = (unsigned int)rx_col.size();
+            entry.summary_off = (unsigned int)summary_col.size();
+
+            totals.clear();
+            const char *prev = "";
+            size_t begin = r;
+            for (; r < rows.size() && rows[r]->day == first_day + d; r++) {
+                const OutOrderNode *order = rows[r];
+                appendVarint(med_col, (unsigned int)order->med_id);
+                appendVarint(qty_col, (unsigned int)order->quantity);
+                pair<int, int>& t = totals[order->med_id];
+                t.first += order->quantity;
+                t.second++;
+                entry.total_quantity += order->quantity;
+
+                // ͬһкϲΪһ
+                if (r > begin && strcmp(order->prescription_no, rows[r - 1]->prescription_no) == 0) continue;
+                size_t run = 1;
+                while (r + run < rows.size() && rows[r + run]->day == order->day &&
+                       strcmp(rows[r + run]->prescription_no, order->prescription_no) == 0) {
+                    run++;
+                }
+                size_t shared = 0;
+                while (prev[shared] != '\0' && prev[shared] == order->prescription_no[shared]) shared++;
+                size_t suffix = strlen(order->prescription_no) - shared;
+                appendVarint(rx_col, (unsigned int)run);
+                appendVarint(rx_col, (unsigned int)shared);
+                appendVarint(rx_col, (unsigned int)suffix);
+                rx_col.append(order->prescription_no + shared, suffix);
+                prev = order->prescription_no;
+            }
+            entry.rows = (int)(r - begin);
+            entry.med_count = (int)totals.size();
+            int prev_id = 0;
+            for (const auto& t : totals) {
+                appendVarint(summary_col, (unsigned int)(t.first - prev_id));
+                appendVarint(summary_col, (unsigned int)t.second.first);
+                appendVarint(summary_col, (unsigned int)t.second.second);
+                prev_id = t.first;
+            }
+        }
+        if (r != rows.size()) return -1;    // ڲڷΧڻδ
+
+        HistorySegmentHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HISTORY_MAGIC, 4);
+        header.version = HISTORY_VERSION;
+        header.first_day = first_day;
+        header.last_day = last_day;
+        header.row_count = (int)rows.size();
+
+        string payload;
+        const string *columns[HISTORY_COLUMNS] = {nullptr, &med_col, &qty_col, &rx_col, &summary_col};
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            header.col_offset[c] = (unsigned int)payload.size();
+            if (c == HISTORY_COL_DAYS) {
+                payload.append((const char*)entries.data(), sizeof(HistoryDayEntry) * day_count);
+            } else {
+                payload += *columns[c];
+            }
+            header.col_bytes[c] = (unsigned int)payload.size() - header.col_offset[c];
+            header.col_checksum[c] = checksumBytes(payload.data() + header.col_offset[c], header.col_bytes[c]);
+        }
+
+        char first[11], last[11];
+        formatDayNumber(first_day, first);
+        formatDayNumber(last_day, last);
+        HistorySegment seg;
+        seg.first_day = first_day;
+        seg.last_day = last_day;
+        // ȡ嵥гֹżһܿеļ嵥δµĲֶΣ
+        struct stat st;
+        do {
+            seg.filename = "history_" + string(first) + "_" + string(last) + "_" + to_string(next_seq++) + ".seg";
+        } while (stat(seg.filename.c_str(), &st) == 0);
+        string tmp = seg.filename + ".tmp";
+
+        FILE *fp = fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) return -1;
+        bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                       fwrite(payload.data(), 1, payload.size(), fp) == payload.size() &&
+                       syncFile(fp) == 0;
+        fclose(fp);
+        if (!written || replaceFile(tmp.c_str(), seg.filename.c_str()) != 0 || !mapSegment(seg)) {
+            remove(tmp.c_str());
+            return -1;
+        }
+
+        segments.push_back(seg);
+        if (saveManifest() != 0) {
+            unmapFile(&segments.back().file);
+            segments.pop_back();
+            remove(seg.filename.c_str());
+            return -1;
+        }
+        sealed_through = max(sealed_through, last_day);
+        return 0;
+    }
+};
+
+// linked_stack.h - ջ
+// ڵأڵ㣬ջĽڵҵϸãʱͷ
+template <typename Node>
+class NodePool {
+private:
+    static const int CHUNK_SIZE = 512;  // ÿڵ
+    vector<Node*> chunks;               // ѷĿ
+    int chunk_used;                     // һýڵ
+    Node* free_list;                    // սڵnextָ룩
+    
+public:
+    NodePool() : chunk_used(CHUNK_SIZE), free_list(nullptr) {}
+    ~NodePool() { reset(); }
+    
+    Node* allocate() {
+        if (free_list != nullptr) {
+            Node* node = free_list;
+            free_list = free_list->next;
+            return node;
+        }
+        if (chunk_used == CHUNK_SIZE) {
+            chunks.push_back(static_cast<Node*>(::operator new(sizeof(Node) * CHUNK_SIZE)));
+            chunk_used = 0;
+        }
+        return &chunks.back()[chunk_used++];
+    }
+    
+    void release(Node* node) {
+        node->next = free_list;
+        free_list = node;
+    }
+    
+    // ͷȫڵ㣬
+    void reset() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ::operator delete(chunks[i]);
+        }
+        chunks.clear();
+        chunk_used = CHUNK_SIZE;
+        free_list = nullptr;
+    }
+};
+
+// ҩƷĳյĳ
+struct MedDayTotal {
+    int quantity;               // 
+    int count;                  // ⵥ
+    MedDayTotal() : quantity(0), count(0) {}
+};
+
+// շֶεĳ¼ջ/ջʱͬάֵ
+struct DaySegment {
+    int prescription_count;                 // ճⵥ
+    int total_quantity;                     // ճ
+    unordered_map<int, MedDayTotal> meds;   // ҩƷID -> ջ
+    vector<OutOrderNode*> orders;           // ճⵥջ˳
+    DaySegment() : prescription_count(0), total_quantity(0) {}
+};
+
+// ջֻڵĳⵥڷ浽鵵ղѯʱ͸ϲ
+class LinkedStack {
+private:
+    OutOrderNode* top;          // ջָ
+    int size;                   // ջĴС
+    NodePool<OutOrderNode> pool;            // ڵ
+    unordered_map<int, DaySegment> days;    //  -> շֶΣڴеĽڳⵥ
+    HistoryArchive archive;                 // ѷĳʷ
+    int hot_days;                           // ڴб
+    mutable unordered_map<int, DaySegment> cold_days;   // ѽĹ鵵ջ
+    mutex lock;                             // ʱջջ⣨ѯ鵵ڵ߳нУ
+    
+    // 鵵յķֶΣнڴͬյļ¼ϲ棻ordersֻڴеĳⵥ
+    const DaySegment* findArchivedDay(DayId day) const {
+        auto cached = cold_days.find(day);
+        if (cached != cold_days.end()) return &cached->second;
+        if (cold_days.size() >= HISTORY_CACHE_DAYS) cold_days.clear();
+        
+        DaySegment& seg = cold_days[day];
+        vector<ArchivedMedTotal> meds;
+        seg.prescription_count = archive.readDaySummary(day, meds, &seg.total_quantity);
+        for (size_t i = 0; i < meds.size(); i++) {
+            MedDayTotal& total = seg.meds[meds[i].med_id];
+            total.quantity += meds[i].quantity;
+            total.count += meds[i].count;
+        }
+        auto hot = days.find(day);
+        if (hot != days.end()) {
+            seg.prescription_count += hot->second.prescription_count;
+            seg.total_quantity += hot->second.total_quantity;
+            for (const auto& item : hot->second.meds) {
+                MedDayTotal& total = seg.meds[item.first];
+                total.quantity += item.second.quantity;
+                total.count += item.second.count;
+            }
+            seg.orders = hot->second.orders;
+        }
+        if (seg.prescription_count == 0) {
+            cold_days.erase(day);
+            return nullptr;
+        }
+        return &seg;
+    }
+    
+    // صָһβѯջջǰЧ
+    const DaySegment* findDay(DayId day) const {
+        if (archive.covers(day)) return findArchivedDay(day);
+        auto it = days.find(day);
+        return it == days.end() ? nullptr : &it->second;
+    }
+    
+    const DaySegment* findDay(const string& date) const {
+        return findDay(dateToDayNumber(date.c_str()));
+    }
+    
+public:
+    LinkedStack() : top(nullptr), size(0), hot_days(HISTORY_HOT_DAYS) {}
+    ~LinkedStack() { clear(); }
+    
+    bool isEmpty() const { return top == nullptr; }
+    int getSize() const { return size; }
+    
+    void push(int med_id, int quantity, const char* prescription_no, const char* date) {
+        MetricTimer timer(METRIC_STACK_PUSH);
+        lock_guard<mutex> guard(lock);
+        OutOrderNode* newNode = pool.allocate();
+        newNode->med_id = med_id;
+        newNode->quantity = quantity;
+        strcpy(newNode->prescription_no, prescription_no);
+        strcpy(newNode->date, date);
+        newNode->day = dateToDayNumber(date);
+        newNode->out_time = time(nullptr);
+        newNode->next = top;
+        top = newNode;
+        size++;
+        
+        if (!cold_days.empty()) cold_days.erase(newNode->day);
+        DaySegment& day = days[newNode->day];
+        day.prescription_count++;
+        day.total_quantity += quantity;
+        MedDayTotal& med = day.meds[med_id];
+        med.quantity += quantity;
+        med.count++;
+        day.orders.push_back(newNode);
+    }
+    
+    bool pop(OutOrderNode& order) {
+        MetricTimer timer(METRIC_STACK_POP);
+        lock_guard<mutex> guard(lock);
+        if (top == nullptr) return false;
+        
+        OutOrderNode* temp = top;
+        order = *top;
+        top = top->next;
+        
+        // ջһշֶջһ
+        if (!cold_days.empty()) cold_days.erase(temp->day);
+        auto it = days.find(temp->day);
+        DaySegment& day = it->second;
+        day.prescription_count--;
+        day.total_quantity -= temp->quantity;
+        MedDayTotal& med = day.meds[temp->med_id];
+        med.quantity -= temp->quantity;
+        if (--med.count == 0) day.meds.erase(temp->med_id);
+        day.orders.pop_back();
+        if (day.orders.empty()) days.erase(it);
+        
+        pool.release(temp);
+        size--;
+        return true;
+    }
+    
+    // ڴеĳⵥ鵵Ӱ죩
+    void clear() {
+        pool.reset();
+        top = nullptr;
+        size = 0;
+        days.clear();
+        cold_days.clear();
+    }
+    
+    // ù鵵ֶ嵥˺keep_daysĳⵥsealExpired档0ɹ-1зֶ޷ȡ
+    int openArchive(const char *manifest, int keep_days) {
+        hot_days = max(1, keep_days);
+        cold_days.clear();
+        return archive.open(manifest);
+    }
+    
+    // ѷڲٱڴУطˮ־ʱݴ
+    bool isArchived(DayId day) const { return day <= archive.sealedThrough(); }
+    const HistoryArchive& getArchive() const { return archive; }
+    
+    // ڱڵĳⵥΪһ·ֶβƳڴ档ط-1дʧܣڴ治䣩
+    int sealExpired(DayId today) {
+        if (!archive.isOpen() || top == nullptr) return 0;
+        DayId cutoff = today - hot_days + 1;
+        DayId first_day = cutoff;
+        for (const auto& item : days) first_day = min(first_day, (DayId)item.first);
+        if (first_day >= cutoff) return 0;
+        
+        // ͬյĳⵥշֶѰջ˳Уȡ
+        vector<DayId> sealed_days;
+        for (const auto& item : days) {
+            if (item.first < cutoff) sealed_days.push_back(item.first);
+        }
+        sort(sealed_days.begin(), sealed_days.end());
+        vector<const OutOrderNode*> rows;
+        for (size_t i = 0; i < sealed_days.size(); i++) {
+            const vector<OutOrderNode*>& orders = days[sealed_days[i]].orders;
+            rows.insert(rows.end(), orders.begin(), orders.end());
+        }
+        DayId last_day = max(cutoff - 1, archive.sealedThrough());
+        if (archive.seal(rows, first_day, last_day) != 0) {
+            logEvent(LOG_ERROR, "history", "seal %d orders before day %d failed", (int)rows.size(), cutoff);
+            return -1;
+        }
+        
+        // ժѷĽڵ
+        OutOrderNode** link = &top;
+        while (*link != nullptr) {
+            OutOrderNode* node = *link;
+            if (node->day < cutoff) {
+                *link = node->next;
+                pool.release(node);
+            } else {
+                link = &node->next;
+            }
+        }
+        for (size_t i = 0; i < sealed_days.size(); i++) days.erase(sealed_days[i]);
+        size -= (int)rows.size();
+        cold_days.clear();
+        logEvent(LOG_INFO, "history", "sealed %d orders, days %d..%d, segments=%d",
+                 (int)rows.size(), first_day, last_day, archive.segmentCount());
+        return (int)rows.size();
+    }
+    
+    OutOrderNode* getTop() const { return top; }
+    
+    // ȡָڵĳֶΣ޼¼nullptr
+    const DaySegment* getDaySegment(const string& date) const {
+        return findDay(date);
+    }
+    
+    const DaySegment* getDaySegment(DayId day) const {
+        return findDay(day);
+    }
+    
+    // ȡָڵĳͳ
+    int getDailyOutTotal(const string& date) const {
+        const DaySegment* day = findDay(date);
+        return day == nullptr ? 0 : day->total_quantity;
+    }
+    
+    // ȡָҩƷĳͳ
+    int getMedicineOutTotal(int med_id, const string& date) const {
+        const DaySegment* day = findDay(date);
+        if (day == nullptr) return 0;
+        auto it = day->meds.find(med_id);
+        return it == day->meds.end() ? 0 : it->second.quantity;
+    }
+    
+    // ȡָڵĴ
+    int getPrescriptionCount(const string& date) const {
+        const DaySegment* day = findDay(date);
+        return day == nullptr ? 0 : day->prescription_count;
+    }
+    
+    // ȡָڵгⵥջǰ鵵ڴӷֶļȡ
+    vector<OutOrderNode> getDailyOrders(const string& date) const {
+        vector<OutOrderNode> orders;
+        DayId day_id = dateToDayNumber(date.c_str());
+        auto hot = days.find(day_id);
+        if (hot != days.end()) {
+            orders.reserve(hot->second.orders.size());
+            for (auto it = hot->second.orders.rbegin(); it != hot->second.orders.rend(); ++it) {
+                orders.push_back(**it);
+            }
+        }
+        if (archive.covers(day_id)) {
+            vector<OutOrderNode> archived;
+            archive.readDayOrders(day_id, archived);
+            orders.insert(orders.end(), archived.rbegin(), archived.rend());
+        }
+        return orders;
+    }
+    
+    // ȡڴегⵥѹ鵵İgetDailyOrdersȡ
+    vector<OutOrderNode> getAllOrders() const {
+        vector<OutOrderNode> orders;
+        OutOrderNode* current = top;
+        while (current != nullptr) {
+            orders.push_back(*current);
+            current = current->next;
+        }
+        return orders;
+    }
+};
+
+// warning_kernels.h - ԤںˣAVX2ʱCPUѡAVX2ʱ߱汾
+// ռ"<ֵ"뵱ǰԤ״̬һµ±꣬ظslotsn
+typedef int (*WarningFlipKernel)(const int *stock, const int *threshold,
+                                 const unsigned char *warning, int n, int *slots);
+// ֵ = max((վ>0 ? վ : һ) * 0.1, 1)
+typedef void (*ThresholdKernel)(const int *avg, const int *last_usage, int n, int *threshold);
+
+int collectWarningFlipsScalar(const int *stock, const int *threshold,
+                              const unsigned char *warning, int n, int *slots) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        slots[count] = i;
+        count += (stock[i] < threshold[i]) != (warning[i] != 0);
+    }
+    return count;
+}
+
+void computeThresholdsScalar(const int *avg, const int *last_usage, int n, int *threshold) {
+    for (int i = 0; i < n; i++) {
+        int base = avg[i] > 0 ? avg[i] : last_usage[i];
+        threshold[i] = max(static_cast<int>(base * 0.1), 1);
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+inline int lowestSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+TARGET_AVX2
+int collectWarningFlipsAvx2(const int *stock, const int *threshold,
+                            const unsigned char *warning, int n, int *slots) {
+    const __m256i zero = _mm256_setzero_si256();
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(stock + i));
+        __m256i t = _mm256_loadu_si256((const __m256i*)(threshold + i));
+        __m256i w = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(warning + i)));
+        __m256i flip = _mm256_xor_si256(_mm256_cmpgt_epi32(t, s), _mm256_cmpgt_epi32(w, zero));
+        unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(flip));
+        while (mask != 0) {     // Ҫתĺ٣ֱ
+            slots[count++] = i + lowestSetBit(mask);
+            mask &= mask - 1;
+        }
+    }
+    for (; i < n; i++) {
+        slots[count] = i;
+        count += (stock[i] < threshold[i]) != (warning[i] != 0);
+    }
+    return count;
+}
+
+// 0.1˫ȼ㣬汾λһ
+TARGET_AVX2
+void computeThresholdsAvx2(const int *avg, const int *last_usage, int n, int *threshold) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256d tenth = _mm256_set1_pd(0.1);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(avg + i));
+        __m256i l = _mm256_loadu_si256((const __m256i*)(last_usage + i));
+        __m256i base = _mm256_blendv_epi8(l, a, _mm256_cmpgt_epi32(a, zero));
+        __m256d lo = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(base)), tenth);
+        __m256d hi = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(base, 1)), tenth);
+        __m256i result = _mm256_set_m128i(_mm256_cvttpd_epi32(hi), _mm256_cvttpd_epi32(lo));
+        _mm256_storeu_si256((__m256i*)(threshold + i), _mm256_max_epi32(result, one));
+    }
+    computeThresholdsScalar(avg + i, last_usage + i, n - i, threshold + i);
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    if (!os_saves_ymm) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct WarningKernels {
+    const char *name;
+    WarningFlipKernel collectFlips;
+    ThresholdKernel computeThresholds;
+};
+
+const WarningKernels SCALAR_KERNELS = {"", collectWarningFlipsScalar, computeThresholdsScalar};
+
+// ״εʱCPUֱ֮ӷѡں
+const WarningKernels& warningKernels() {
+#ifdef HAVE_X86_SIMD
+    static const WarningKernels AVX2_KERNELS = {"AVX2", collectWarningFlipsAvx2, computeThresholdsAvx2};
+    static const WarningKernels& selected = cpuHasAvx2() ? AVX2_KERNELS : SCALAR_KERNELS;
+    return selected;
+#else
+    return SCALAR_KERNELS;
+#endif
+}
+
+// warning_logic.h - Ԥ߼
+// daysվֻͳӣO(1)
+int calculateAverageUsage(Medicine *med, int days) {
+    if (med == nullptr) return 0;
+    
+    int sum = getUsageSum(med, days);
+    int count = getActiveUsageDays(med, days);
+    return (count == 0) ? 0 : (sum / count);
+}
+
+int calculateThreeDayAverage(Medicine *med) {
+    return calculateAverageUsage(med, 3);
+}
+
+void setWarningThreshold(Medicine *med) {
+    if (med == nullptr) return;
+    
+    int three_day_avg = calculateThreeDayAverage(med);
+    int threshold;
+
+    if (three_day_avg > 0) {
+        threshold = static_cast<int>(three_day_avg * 0.1);
+    } else {
+        threshold = static_cast<int>(med->last_usage * 0.1);
+    }
+
+    // ȷֵΪ1ֹ0ֵԶԤ
+    threshold = max(threshold, 1);
+    
+    med->warning_threshold = threshold;
+}
+
+// ȫҩƷԤֵֵб仯ҩƷ
+int refreshAllThresholds(OrderedList *inventory) {
+    if (inventory == nullptr || inventory->length == 0) return 0;
+    
+    StructureWriteGuard guard(inventory->lock);
+    int n = inventory->length;
+    vector<int> avg(n), last_usage(n), threshold(n);
+    for (int i = 0; i < n; i++) {
+        avg[i] = calculateThreeDayAverage(&inventory->medicines[i]);
+        last_usage[i] = inventory->medicines[i].last_usage;
+    }
+    warningKernels().computeThresholds(avg.data(), last_usage.data(), n, threshold.data());
+    
+    int changed = 0;
+    for (int i = 0; i < n; i++) {
+        if (threshold[i] != inventory->hot.threshold[i]) {
+            inventory->medicines[i].warning_threshold = threshold[i];
+            inventory->hot.threshold[i] = threshold[i];
+            markWarningDirty(inventory->warnings, inventory->hot.ids[i]);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+// 鵥ҩƷԤ״̬ѳҩƷָ룬ٲң÷д
+// nowΪ/ʱ䣬طˮʱȡ¼ķʱ
+void checkMedicineWarning(OrderedList *inventory, Medicine *med, time_t now) {
+    inventory->warnings->margins.update(med->id, med->stock - med->warning_threshold);
+    
+    // Ƿ񴥷Ԥ
+    if (med->stock < med->warning_threshold && med->is_warning == 0) {
+        med->is_warning = 1;
+        med->warning_time = now;
+        inventory->warnings->raised++;
+        logEvent(LOG_WARN, "warning", "Ԥ id=%d name=%s stock=%d threshold=%d",
+                 med->id, med->name, med->stock, med->warning_threshold);
+    }
+    // ǷԤ
+    else if (med->stock >= med->warning_threshold && med->is_warning == 1) {
+        med->is_warning = 0;
+        med->response_time = now;
+        recordDailyResponse(inventory->daily, med->warning_time, med->response_time);
+        double response_hour = difftime(med->response_time, med->warning_time) / 3600.0;
+        inventory->warnings->cleared++;
+        logEvent(LOG_INFO, "warning", "Ԥ id=%d name=%s stock=%d response_hours=%.2f",
+                 med->id, med->name, med->stock, response_hour);
+    }
+    syncMedicineColumns(inventory, med);
+}
+
+// ʵʱ鲢Ԥ״̬
+void checkAndHandleWarnings(OrderedList *inventory, int med_id) {
+    MetricTimer timer(METRIC_CHECK_WARNINGS);
+    if (inventory == nullptr) return;
+    
+    StructureWriteGuard guard(inventory->lock);
+    Medicine *med = findMedicine(inventory, med_id);
+    if (med == nullptr) return;
+    
+    checkMedicineWarning(inventory, med, time(NULL));
+}
+
+// Ǽǹ䶯ҩƷ÷дҩƷ
+int evaluateDirtyWarnings(OrderedList *inventory, time_t now) {
+    WarningEngine *engine = inventory->warnings;
+    vector<int> dirty;
+    {
+        lock_guard<mutex> guard(engine->dirty_lock);
+        dirty.swap(engine->dirty);
+        engine->dirty_set.clear();
+    }
+    
+    int evaluated = 0;
+    for (size_t i = 0; i < dirty.size(); i++) {
+        Medicine *med = findMedicine(inventory, dirty[i]);
+        if (med == nullptr) {
+            engine->margins.remove(dirty[i]); // ɾҩƷ
+        } else {
+            checkMedicineWarning(inventory, med, now);
+            evaluated++;
+        }
+    }
+    return evaluated;
+}
+
+// Ԥ飺ֻǼǹ䶯ҩƷҩƷ
+int autoCheckWarnings(OrderedList *inventory) {
+    if (inventory == nullptr) return 0;
+    
+    StructureWriteGuard guard(inventory->lock);
+    return evaluateDirtyWarnings(inventory, time(NULL));
+}
+
+// ȡǰԤҩƷֵID
+vector<Medicine*> getWarningMedicines(OrderedList *inventory) {
+    autoCheckWarnings(inventory);
+    
+    vector<int> ids;
+    inventory->warnings->margins.collectBelow(0, ids);
+    sort(ids.begin(), ids.end());
+    
+    vector<Medicine*> result;
+    for (size_t i = 0; i < ids.size(); i++) {
+        Medicine *med = findMedicine(inventory, ids[i]);
+        if (med != nullptr && med->is_warning) result.push_back(med);
+    }
+    return result;
+}
+
+// ҩƷԤ״̬ȫ㣬ճautoCheckWarningsɣ
+void updateAllWarnings(OrderedList *inventory) {
+    if (inventory == nullptr || inventory->length == 0) {
+        cout << "棺ΪգԤ״̬" << endl;
+        return;
+    }
+
+    cout << "\n===== ʼҩƷԤ״̬ =====" << endl;
+    StructureWriteGuard guard(inventory->lock);
+    time_t now = time(NULL);
+    evaluateDirtyWarnings(inventory, now);
+
+    // ɨֶУֻ״̬ҪתҩƷŷ¼
+    const MedicineColumns *hot = &inventory->hot;
+    vector<int> flips(inventory->length);
+    int count = warningKernels().collectFlips(hot->stock, hot->threshold, hot->warning,
+                                              inventory->length, flips.data());
+    for (int k = 0; k < count; k++) {
+        checkMedicineWarning(inventory, &inventory->medicines[flips[k]], now);
+    }
+    inventory->warnings->margins.rebuild(hot->ids, hot->stock, hot->threshold, inventory->length);
+    cout << "===== Ԥ״̬ =====" << endl;
+}
+
+// 
+typedef struct {
+    int orders;                 // ⵥ
+    int medicines;              // 漰ҩƷ
+    long long quantity;         // 
+    int unknown;                // ҩƷڵⵥ
+    int overflow;               // ϼƺ󳬳޶δⵥ
+} InBatchSummary;
+
+// һⵥϲڿҩƷID򲢺ϲͬһҩƷ
+// 밴IDĿ鲢ÿҩƷֻǼһԤ
+// ӿʱCASޣϼʹ泬intΧҩƷ鲻
+InBatchSummary applyInOrderBatch(OrderedList *inventory, const InOrder *orders, int n, bool apply_stock) {
+    InBatchSummary summary = {n, 0, 0, 0, 0};
+    
+    vector<pair<int, int>> items(n);        // (ҩƷID, )
+    for (int k = 0; k < n; k++) {
+        items[k] = make_pair(orders[k].med_id, orders[k].quantity);
+    }
+    sort(items.begin(), items.end());
+    
+    StructureReadGuard guard(inventory->lock);
+    const int *ids = inventory->hot.ids;
+    int i = 0;
+    for (int k = 0; k < n; ) {
+        int id = items[k].first;
+        int count = 0;
+        long long quantity = 0;
+        for (; k < n && items[k].first == id; k++) {
+            quantity += items[k].second;
+            count++;
+        }
+        
+        while (i < inventory->length && ids[i] < id) i++;
+        if (i == inventory->length || ids[i] != id) {
+            summary.unknown += count;
+            continue;
+        }
+        if (apply_stock) {
+            int *stock = &inventory->hot.stock[i];
+            int old_stock = atomicLoadInt(stock);
+            bool fits;
+            do {
+                fits = quantity <= (long long)INT_MAX - old_stock;
+            } while (fits && !atomicCasInt(stock, &old_stock, old_stock + (int)quantity));
+            if (!fits) {
+                summary.overflow += count;
+                logEvent(LOG_ERROR, "inbound", "med_id=%d batch quantity %lld exceeds stock limit, not applied",
+                         id, quantity);
+                continue;
+            }
+            atomicAddInt(&inventory->medicines[i].stock, (int)quantity);
+        }
+        markWarningDirty(inventory->warnings, id);
+        summary.medicines++;
+        summary.quantity += quantity;
+    }
+    return summary;
+}
+
+// ⵥڵǼʱӣȡҩƷϲͳһԤ
+bool processInOrder(CircularQueue *queue, OrderedList *inventory) {
+    if (queue == nullptr || inventory == nullptr) {
+        cout << "󣺲Ч" << endl;
+        return false;
+    }
+    
     if (queue->size == 0) {
         cout << "ʾûдⵥ" << endl;
         return false;
     }
     
+    vector<InOrder> orders;
+    int n = takeAllInOrders(queue, orders);
+    InBatchSummary summary = applyInOrderBatch(inventory, orders.data(), n, false);
+    autoCheckWarnings(inventory);
+    logEvent(LOG_INFO, "inbound", "processed orders=%d medicines=%d quantity=%lld unknown=%d",
+             n - summary.unknown, summary.medicines, summary.quantity, summary.unknown);
+    
+    cout << " " << n - summary.unknown << " ⵥ漰ҩƷ " << summary.medicines
+         << " ֣ " << summary.quantity << "g" << endl;
+    if (summary.unknown > 0) {
+        cout << "棺" << summary.unknown << " ⵥҩƷڣ" << endl;
+    }
+    return n > summary.unknown;
+}
+
+// journal.h - ˮ־Ԥд־̣
+#define JOURNAL_FILE "stock.journal"
+#define JOURNAL_BATCH_SIZE 64       // ܹôδ̼¼ʱǿύ
+#define JOURNAL_IN  1               // 
+#define JOURNAL_OUT 2               // 
+
+// ˮ¼
+typedef struct {
+    unsigned int seq;           // ˮţ
+    int type;                   // JOURNAL_IN / JOURNAL_OUT
+    int med_id;                 // ҩƷ
+    int quantity;               // 
+    time_t event_time;          // ʱ
+    char date[11];              // 
+    char ref[30];               // ΪԱΪ
+    unsigned int checksum;      // ֶεУ
+} JournalRecord;
+
+typedef struct {
+    FILE *fp;                   // ׷ӷʽ򿪵־ļ
+    unsigned int next_seq;      // һ¼
+    int pending;                // д뵫δ̵ļ¼
+    int batch_size;             // ύС
+    mutex lock;                 // ̲߳׷ӡύ
+} Journal;
+
+unsigned int journalChecksum(const JournalRecord *rec) {
+    return checksumBytes(rec, offsetof(JournalRecord, checksum));
+}
+
+// ضļָȣȥʱдһβ¼
+int truncateFile(const char *filename, long size) {
+#ifdef _WIN32
+    int fd = _open(filename, _O_RDWR | _O_BINARY);
+    if (fd < 0) return -1;
+    int ret = _chsize(fd, size);
+    _close(fd);
+#else
+    int ret = truncate(filename, size);
+#endif
+    return ret;
+}
+
+// ־¼¼next_seqʼ
+Journal* openJournal(const char *filename, unsigned int next_seq, int batch_size) {
+    FILE *fp = fopen(filename, "ab");
+    if (fp == nullptr) return nullptr;
+
+    Journal *journal = new Journal;
+    journal->fp = fp;
+    journal->next_seq = next_seq;
+    journal->pending = 0;
+    journal->batch_size = batch_size > 0 ? batch_size : 1;
+    return journal;
+}
+
+// ˮдʧܺ޷ȷЩ¼ѵ̣÷ȴᰴʧܴлʹ־
+// һ£¼˳ʱɿռϴϵ¼ָ
+void journalFailure(const char *what) {
+    logEvent(LOG_ERROR, "journal", "%s failed (errno=%d), exiting", what, errno);
+    stopSystemLog();
+    cout << "شˮ־дʧܣ" << what << "ϵͳ˳"
+         << "̺պˮ־ָ" << endl;
+    exit(EXIT_FAILURE);
+}
+
+// ȫδ̼¼÷journal->lock
+void syncPendingRecords(Journal *journal) {
+    if (journal->pending == 0) return;
+    if (syncFile(journal->fp) != 0) journalFailure("sync");
+    journal->pending = 0;
+}
+
+// ύδ̵ļ¼һˢ̣ʧʱ˳򣬲᷵
+int commitJournal(Journal *journal) {
+    if (journal == nullptr) return 0;
+    lock_guard<mutex> guard(journal->lock);
+    syncPendingRecords(journal);
+    return 0;
+}
+
+void closeJournal(Journal *journal) {
+    if (journal != nullptr) {
+        commitJournal(journal);
+        fclose(journal->fp);
+        delete journal;
+    }
+}
+
+// ׷һˮɶ̲߳ãʱԶύŲƽsaveCheckpoint
+int appendJournal(Journal *journal, int type, int med_id,
+                  int quantity, const char *ref, const char *date, time_t event_time) {
+    if (journal == nullptr) return -1;
+
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.med_id = med_id;
+    rec.quantity = quantity;
+    rec.event_time = event_time;
+    strncpy(rec.date, date, sizeof(rec.date) - 1);
+    strncpy(rec.ref, ref, sizeof(rec.ref) - 1);
+
+    lock_guard<mutex> guard(journal->lock);
+    rec.seq = journal->next_seq++;
+    rec.checksum = journalChecksum(&rec);
+    if (fwrite(&rec, sizeof(rec), 1, journal->fp) != 1) journalFailure("write");
+
+    if (++journal->pending >= journal->batch_size) syncPendingRecords(journal);
+    return 0;
+}
+
+// ָڵʷ
+void recordUsage(Medicine *med, DayId day, int quantity) {
+    if (day == g_current_day && getDayUsage(med, 0) == 0) { // ǵһγ
+        med->last_usage = quantity;
+    }
+    recordUsageOnDay(med, day, quantity);
+}
+
+// ҩƷIDɶ̲߳ãڽṹڰ±ȡҩƷݺʧЧָ룻
+// ͬһҩƷʷɰIDƬĻ
+void recordUsageById(OrderedList *list, int id, DayId day, int quantity) {
+    static mutex usage_locks[LOCK_SHARDS];
+    StructureReadGuard guard(list->lock);
+    int i = findMedicineSlot(list, id);
+    if (i < 0) return;
+    lock_guard<mutex> usage_guard(usage_locks[(unsigned int)id % LOCK_SHARDS]);
+    recordUsage(&list->medicines[i], day, quantity);
+}
+
+// ڿջط־Ŵڿŵļ¼ڿ棬¼ķʱԤ
+// ʱʵһ£밴ͳƣŴͼŵ¼ͳƣ
+// ȫ¼ָⵥݡһЧ¼
+unsigned int replayJournal(const char *filename, OrderedList *inventory,
+                           CircularQueue *inQueue, LinkedStack *outStack) {
+    unsigned int last_seq = inventory->journal_seq;
+    FILE *fp = fopen(filename, "rb");
+    if (fp == nullptr) return last_seq;
+
+    refreshCurrentDay();
+
+    JournalRecord rec;
+    long valid_bytes = 0;
+    int replayed = 0, skipped = 0;
+    while (fread(&rec, sizeof(rec), 1, fp) == 1 && rec.checksum == journalChecksum(&rec)) {
+        valid_bytes += sizeof(rec);
+        if (rec.seq > last_seq) last_seq = rec.seq;
+
+        Medicine *med = findMedicine(inventory, rec.med_id);
+        bool apply = rec.seq > inventory->journal_seq && med != nullptr;
+        bool count_daily = rec.seq > inventory->daily->journal_seq && med != nullptr;
+        DayId rec_day = dateToDayNumber(rec.date);
+        if (med == nullptr && rec.seq > inventory->journal_seq) {
+            skipped++;
+            logEvent(LOG_WARN, "journal", "record seq=%u skipped: medicine %d not in snapshot",
+                     rec.seq, rec.med_id);
+        }
+
+        if (rec.type == JOURNAL_IN) {
+            if (apply) increaseStock(inventory, rec.med_id, rec.quantity);
+            if (count_daily) recordDailyInbound(inventory->daily, rec_day, rec.med_id, rec.quantity);
+            if (rec_day == g_current_day) {
+                InOrder order;
+                memset(&order, 0, sizeof(order));
+                order.med_id = rec.med_id;
+                order.quantity = rec.quantity;
+                snprintf(order.operator_name, sizeof order.operator_name, "%.*s",
+                         (int)sizeof order.operator_name - 1, rec.ref);  // ԱⵥֶγȽض
+                order.in_time = rec.event_time;
+                strcpy(order.date, rec.date);
+                order.day = rec_day;
+                enqueue(inQueue, order);
+            }
+        } else if (rec.type == JOURNAL_OUT) {
+            if (apply) {
+                increaseStock(inventory, rec.med_id, -rec.quantity); // ־ԭطţУ
+                recordUsage(med, rec_day, rec.quantity);
+            }
+            if (count_daily) recordDailyOutbound(inventory->daily, rec_day, rec.med_id, rec.quantity);
+            if (!outStack->isArchived(rec_day)) {
+                outStack->push(rec.med_id, rec.quantity, rec.ref, rec.date);
+                outStack->getTop()->out_time = rec.event_time;
+            }
+        }
+
+        if (apply) {
+            StructureWriteGuard guard(inventory->lock);
+            checkMedicineWarning(inventory, med, rec.event_time);
+            replayed++;
+        }
+    }
+    fclose(fp);
+    autoCheckWarnings(inventory);
+
+    // ʱдһβ¼֮׷Ӳܶ
+    truncateFile(filename, valid_bytes);
+
+    inventory->journal_seq = last_seq;
+    inventory->daily->journal_seq = last_seq;
+    if (replayed > 0) {
+        logEvent(LOG_INFO, "journal", "replayed %d records, last_seq=%u", replayed, last_seq);
+    }
+    if (skipped > 0) {
+        logEvent(LOG_WARN, "journal", "%d records skipped for medicines not in snapshot", skipped);
+    }
+    return last_seq;
+}
+
+// 㣺ύˮ󣬰̵һˮΪűա
+// ˮ޸Ŀ֮ǰд룬ύʱӦĿ޸ľɣ˵̴ִ߳У
+int saveCheckpoint(OrderedList *inventory, Journal *journal, const char *filename) {
+    if (journal != nullptr) {
+        commitJournal(journal);
+        inventory->journal_seq = journal->next_seq - 1;
+    }
+    return saveToFile(inventory, filename);
+}
+
+// ѹˮ־ֻռ֮ãͰͳƶڿУֻ豣ؽ
+// ļ¼յⵥδ鵵ڵĳⵥඪдʱļ滻
+// ־֮ԼHISTORY_HOT_DAYSĳضļ¼-1ʧܣԭ־䣩
+int compactJournal(Journal *journal, const char *filename, LinkedStack *outStack) {
+    commitJournal(journal);
+    FILE *in = fopen(filename, "rb");
+    if (in == nullptr) return -1;
+    string tmp_name = string(filename) + ".tmp";
+    FILE *out = fopen(tmp_name.c_str(), "wb");
+    if (out == nullptr) {
+        fclose(in);
+        return -1;
+    }
+
+    refreshCurrentDay();
+    JournalRecord rec;
+    int kept = 0, dropped = 0;
+    bool ok = true;
+    while (ok && fread(&rec, sizeof(rec), 1, in) == 1 && rec.checksum == journalChecksum(&rec)) {
+        DayId day = dateToDayNumber(rec.date);
+        bool keep = rec.type == JOURNAL_IN ? day == g_current_day : !outStack->isArchived(day);
+        if (!keep) {
+            dropped++;
+            continue;
+        }
+        ok = fwrite(&rec, sizeof(rec), 1, out) == 1;
+        kept++;
+    }
+    fclose(in);
+    ok = syncFile(out) == 0 && ok;
+    ok = (fclose(out) == 0) && ok;
+    if (!ok || dropped == 0) {
+        remove(tmp_name.c_str());
+        return ok ? 0 : -1;
+    }
+
+    // ȹر׷Ӿ滻Windows滻еļ滻´
+    lock_guard<mutex> guard(journal->lock);
+    fclose(journal->fp);
+    int ret = replaceFile(tmp_name.c_str(), filename);
+    if (ret != 0) remove(tmp_name.c_str());
+    journal->fp = fopen(filename, "ab");
+    if (journal->fp == nullptr) journalFailure("reopen");
+    if (ret != 0) return -1;
+    logEvent(LOG_INFO, "journal", "compacted: kept %d records, dropped %d", kept, dropped);
+    return dropped;
+}
+
+// ղѹˮ־ֻʱգǱݿգ֮ܶ¼
+int checkpointCatalogue(OrderedList *inventory, Journal *journal, LinkedStack *outStack) {
+    if (saveCheckpoint(inventory, journal, CATALOGUE_FILE) != 0) return -1;
+    if (journal != nullptr && compactJournal(journal, JOURNAL_FILE, outStack) < 0) {
+        logEvent(LOG_WARN, "journal", "compaction failed, journal kept as is");
+    }
+    return 0;
+}
+
+// ҩƷĿ¼ɾģ롢˵ֱӸĿ棩дˮգ
+// ֮ˮطʱҵӦҩƷwhatΪ˵ֻ־
+int saveCatalogueChange(OrderedList *inventory, Journal *journal, LinkedStack *outStack, const char *what) {
+    if (checkpointCatalogue(inventory, journal, outStack) != 0) {
+        logEvent(LOG_ERROR, "storage", "save %s after %s failed", CATALOGUE_FILE, what);
+        return -1;
+    }
+    return 0;
+}
+
+// ݱݣգˮ־
+int backupData(OrderedList *inventory, Journal *journal, const char *backup_name) {
+    string snapshot = string(backup_name) + ".dat";
+    string journal_copy = string(backup_name) + ".journal";
+    if (saveCheckpoint(inventory, journal, snapshot.c_str()) != 0) return -1;
+
+    ifstream src(JOURNAL_FILE, ios::binary);
+    ofstream dst(journal_copy.c_str(), ios::binary | ios::trunc);
+    if (!dst) return -1;
+    if (src) dst << src.rdbuf();
+    return dst.good() ? 0 : -1;
+}
+
+// ݻָ뱸ݿղطű־滻ǰͳⵥ
+int restoreData(OrderedList *inventory, CircularQueue *inQueue, LinkedStack *outStack,
+                Journal *journal, const char *backup_name) {
+    string snapshot = string(backup_name) + ".dat";
+    string journal_copy = string(backup_name) + ".journal";
+
+    LoadStatus status;
+    OrderedList *restored = loadFromFile(snapshot.c_str(), &status);
+    if (restored == nullptr) return -1;
+
+    // ־Ϊǰ־
+    commitJournal(journal);
+    ifstream src(journal_copy.c_str(), ios::binary);
+    ofstream dst(JOURNAL_FILE, ios::binary | ios::trunc);
+    if (src) dst << src.rdbuf();
+    dst.close();
+    if (!dst) {
+        destroyOrderedList(restored);
+        return -1;
+    }
+
+    // ԭ滻÷еָ뱣Чԭȴе߳õͬһ
+    {
+        StructureWriteGuard guard(inventory->lock);
+        OrderedList old = *inventory;
+        *inventory = *restored;
+        *restored = old;
+        swap(inventory->lock, restored->lock);
+    }
+    destroyOrderedList(restored);
+
+    inQueue->front = inQueue->rear = inQueue->size = 0;
+    outStack->clear();
+    journal->next_seq = replayJournal(JOURNAL_FILE, inventory, inQueue, outStack) + 1;
+
+    fclose(journal->fp);
+    journal->fp = fopen(JOURNAL_FILE, "ab");
+    journal->pending = 0;
+    if (journal->fp == nullptr) return -1;
+    return checkpointCatalogue(inventory, journal, outStack);
+}
+
+// Ǽ⣨ɶ̲߳ãCASӿ棨ᳬʱܾдˮдˮ־
+// дʧ˻أⵥУ*queuedʾǷӳɹwhenΪʱ䣨0ʾǰʱ䣩
+// 0ɹ-1ҩƷڣ-2дˮ־ʧܣδ䣩-3泬ޣδ䣩
+int receiveMedicine(OrderedList *inventory, CircularQueue *inQueue, Journal *journal,
+                    int med_id, int quantity, const char *operator_name, bool *queued, time_t when) {
+    int added = increaseStock(inventory, med_id, quantity);
+    if (added == -1) return -1;
+    if (added != 0) return -3;
+    
+    InOrder order;
+    memset(&order, 0, sizeof(order));
+    order.med_id = med_id;
+    order.quantity = quantity;
+    strncpy(order.operator_name, operator_name, sizeof(order.operator_name) - 1);
+    order.in_time = when != 0 ? when : time(nullptr);
+    tm local;
+    toLocalTime(order.in_time, &local);
+    strftime(order.date, sizeof(order.date), "%Y-%m-%d", &local);
+    order.day = dateToDayNumber(order.date);
+    
+    if (appendJournal(journal, JOURNAL_IN, med_id, quantity,
+                      order.operator_name, order.date, order.in_time) != 0) {
+        increaseStock(inventory, med_id, -quantity);
+        return -2;
+    }
+    recordDailyInbound(inventory->daily, order.day, med_id, quantity);
+    lock_guard<mutex> guard(inQueue->lock);
+    *queued = enqueue(inQueue, order);
+    return 0;
+}
+
+// Ǽǳ⣨ɶ̲߳ãCASۼԤʱᳬۣдˮ־
+// дʧ˻ԤⵥջҩƷIDʷwhenΪʱ䣨0ʾǰʱ䣩
+// 0ɹ-1ҩƷڣ-2治㣬-3дˮ־ʧܣδ䣩
+int dispenseMedicine(OrderedList *inventory, LinkedStack *outStack, Journal *journal,
+                     int med_id, int quantity, const char *prescription_no, time_t when) {
+    int reserved = decreaseStock(inventory, med_id, quantity);
+    if (reserved != 0) return reserved;     // -1ҩƷڣ-2治
+    
+    time_t now = when != 0 ? when : time(nullptr);
+    char date[11];
+    tm local;
+    toLocalTime(now, &local);
+    strftime(date, sizeof(date), "%Y-%m-%d", &local);
+    
+    if (appendJournal(journal, JOURNAL_OUT, med_id, quantity,
+                      prescription_no, date, now) != 0) {
+        increaseStock(inventory, med_id, quantity);
+        return -3;
+    }
+    outStack->push(med_id, quantity, prescription_no, date);
+    recordDailyOutbound(inventory->daily, dateToDayNumber(date), med_id, quantity);
+    recordUsageById(inventory, med_id, dateToDayNumber(date), quantity);
+    return 0;
+}
+
+// еⵥȡնкдˮֻһΣٰҩƷϲӿ
+#define IN_ORDER_BATCH 64
+
+int processInOrder(MpscInQueue *queue, OrderedList *inventory, Journal *journal) {
+    if (queue == nullptr || inventory == nullptr) return 0;
+    
+    vector<InOrder> orders;
+    InOrder batch[IN_ORDER_BATCH];
+    int n;
+    while ((n = queue->dequeueBatch(batch, IN_ORDER_BATCH)) > 0) {
+        orders.insert(orders.end(), batch, batch + n);
+    }
+    
+    // ҩƷϼƱϼƺʹ泬޵ҩƷգдˮ
+    unordered_map<int, long long> totals;
+    for (size_t i = 0; i < orders.size(); i++) {
+        totals[orders[i].med_id] += orders[i].quantity;
+    }
+    
+    // дˮ־дʧܻյⵥڿ棩
+    int skipped_count = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < orders.size(); i++) {
+        const InOrder& order = orders[i];
+        Medicine *med = findMedicine(inventory, order.med_id);
+        if (med != nullptr && totals[order.med_id] > (long long)INT_MAX - atomicLoadInt(&med->stock)) {
+            skipped_count++;
+            continue;
+        }
+        if (journal != nullptr && med != nullptr &&
+            appendJournal(journal, JOURNAL_IN, order.med_id, order.quantity,
+                          order.operator_name, order.date, order.in_time) != 0) {
+            skipped_count++;
+            continue;
+        }
+        orders[kept++] = order;
+    }
+    // ˮ̺ڿ棻ʧʱcommitJournal¼˳ⵥЧ
+    if (commitJournal(journal) != 0) return 0;
+    
+    InBatchSummary summary = applyInOrderBatch(inventory, orders.data(), (int)kept, true);
+    for (size_t i = 0; i < kept; i++) {
+        if (findMedicine(inventory, orders[i].med_id) != nullptr) {
+            recordDailyInbound(inventory->daily, orders[i].day, orders[i].med_id, orders[i].quantity);
+        }
+    }
+    autoCheckWarnings(inventory); // ÿӰҩƷֻһ
+    
+    skipped_count += summary.unknown + summary.overflow;
+    logEvent(LOG_INFO, "inbound", "batch orders=%d medicines=%d quantity=%lld",
+             summary.orders - summary.unknown - summary.overflow, summary.medicines, summary.quantity);
+    if (skipped_count > 0) {
+        logEvent(LOG_WARN, "inbound", "%d orders skipped (unknown medicine, stock limit or journal failure)",
+                 skipped_count);
+    }
+    return (int)kept - summary.unknown - summary.overflow;
+}
+
+// ͳƹܽṹ
+struct MedicineUsage {
+    int med_id;
+    string med_name;
+    int total_usage;
+    int usage_frequency;
+    double usage_percentage;
+    
+    MedicineUsage(int id = 0, const string& name = "")
+        : med_id(id), med_name(name), total_usage(0), usage_frequency(0), usage_percentage(0.0) {}
+    
+    bool operator<(const MedicineUsage& other) const {
+        return total_usage > other.total_usage; // 
+    }
+};
+
+class Statistics {
+private:
+    CircularQueue* in_queue;
+    LinkedStack* out_stack;
+    OrderedList* inventory;
+    
+public:
+    Statistics(OrderedList* inv, CircularQueue* queue = nullptr, LinkedStack* stack = nullptr) 
+        : inventory(inv), in_queue(queue), out_stack(stack) {}
+    
+    void setDataSources(OrderedList* inv, CircularQueue* queue, LinkedStack* stack) {
+        inventory = inv;
+        in_queue = queue;
+        out_stack = stack;
+    }
+    
+    struct DailyStats {
+        string date;
+        int prescription_count;
+        int total_dosage;
+        int in_orders_count;
+        int out_orders_count;
+        double avg_response_time;
+        
+        DailyStats(const string& d = "") : date(d), prescription_count(0),
+            total_dosage(0), in_orders_count(0), out_orders_count(0), avg_response_time(0.0) {}
+    };
+    
+    // ȡÿͳƣȡԳջշֶΣԤӦȡ԰ͳͼΪO(1)
+    DailyStats getDailyStats(const string& date) const {
+        DailyStats stats(date);
+        DayId day = dateToDayNumber(date.c_str());
+        
+        // ͳƴܼջʱշֶͬۼ
+        const DaySegment* segment = out_stack->getDaySegment(day);
+        if (segment != nullptr) {
+            stats.prescription_count = segment->prescription_count;
+            stats.total_dosage = segment->total_quantity;
+        }
+        stats.out_orders_count = stats.prescription_count;
+        
+        // յǼǵⵥѴӵģ뵱սԤ
+        DailyAggregate agg = getDailyAggregate(inventory->daily, day);
+        stats.in_orders_count = agg.in_orders;
+        stats.avg_response_time = agg.responses > 0 ? agg.response_hours / agg.responses : 0.0;
+        
+        return stats;
+    }
+    
+    // [first_day, last_day]ڸҩƷƵΣնȡֶεĻֵ
+    // ҩƷڿе±ۼӵƽ飬ȡǰtop_k0ʾȫ
+    vector<MedicineUsage> aggregateUsage(DayId first_day, DayId last_day, size_t top_k, bool by_frequency) const {
+        vector<MedicineUsage> usage_list;
+        if (out_stack == nullptr || inventory == nullptr) return usage_list;
+        
+        vector<int> usage(inventory->length, 0);
+        vector<int> freq(inventory->length, 0);
+        vector<int> touched;                    // г¼±
+        map<int, pair<int, int>> unknown;       // ѲڿеҩƷ
+        
+        for (DayId day = first_day; day <= last_day; day++) {
+            const DaySegment* segment = out_stack->getDaySegment(day);
+            if (segment == nullptr) continue;
+            for (const auto& item : segment->meds) {
+                Medicine* med = findMedicine(inventory, item.first);
+                if (med == nullptr) {
+                    unknown[item.first].first += item.second.quantity;
+                    unknown[item.first].second += item.second.count;
+                    continue;
+                }
+                int slot = med - inventory->medicines;
+                if (usage[slot] == 0 && freq[slot] == 0) touched.push_back(slot);
+                usage[slot] += item.second.quantity;
+                freq[slot] += item.second.count;
+            }
+        }
+        
+        usage_list.reserve(touched.size() + unknown.size());
+        for (size_t i = 0; i < touched.size(); i++) {
+            int slot = touched[i];
+            MedicineUsage item(inventory->medicines[slot].id, inventory->medicines[slot].name);
+            item.total_usage = usage[slot];
+            item.usage_frequency = freq[slot];
+            usage_list.push_back(item);
+        }
+        for (const auto& pair : unknown) {
+            MedicineUsage item(pair.first, "δ֪ҩƷ");
+            item.total_usage = pair.second.first;
+            item.usage_frequency = pair.second.second;
+            usage_list.push_back(item);
+        }
+        
+        long long total = 0;
+        for (const auto& item : usage_list) total += item.total_usage;
+        if (total > 0) {
+            for (auto& item : usage_list) item.usage_percentage = item.total_usage * 100.0 / total;
+        }
+        
+        // ֻǰtop_k
+        auto cmp = [by_frequency](const MedicineUsage& a, const MedicineUsage& b) {
+            int ka = by_frequency ? a.usage_frequency : a.total_usage;
+            int kb = by_frequency ? b.usage_frequency : b.total_usage;
+            return ka != kb ? ka > kb : a.med_id < b.med_id;
+        };
+        if (top_k == 0 || top_k > usage_list.size()) top_k = usage_list.size();
+        partial_sort(usage_list.begin(), usage_list.begin() + top_k, usage_list.end(), cmp);
+        usage_list.resize(top_k);
+        return usage_list;
+    }
+    
+    // ȡָڵҩƷʹͳ
+    vector<MedicineUsage> getMedicineUsage(const string& date) const {
+        DayId day = dateToDayNumber(date.c_str());
+        return aggregateUsage(day, day, 0, false);
+    }
+    
+    // ȡtop_kΪ0ʱȫ
+    vector<MedicineUsage> getUsageRanking(int days = 3, size_t top_k = 0) const {
+        return aggregateUsage(g_current_day - days + 1, g_current_day, top_k, false);
+    }
+    
+    // ȡƵtop_kΪ0ʱȫ
+    vector<MedicineUsage> getFrequencyRanking(int days = 3, size_t top_k = 0) const {
+        return aggregateUsage(g_current_day - days + 1, g_current_day, top_k, true);
+    }
+    
+    // ȡָڵƽԤӦʱ䣺սԤӴƽʱСʱ
+    double getAvgResponseTime(const string& date) const {
+        if (inventory == nullptr) return 0.0;
+        
+        DailyAggregate agg = getDailyAggregate(inventory->daily, dateToDayNumber(date.c_str()));
+        return agg.responses > 0 ? agg.response_hours / agg.responses : 0.0;
+    }
+    
+    // ȽϽ
+    void compareThreeDaysUsage() const {
+        cout << "\n========== ҩԱ ==========" << endl;
+        
+        vector<MedicineUsage> usage_ranking = getUsageRanking(3, 5);
+        vector<MedicineUsage> freq_ranking = getFrequencyRanking(3, 5);
+        
+        cout << "\n1. ǰ5" << endl;
+        cout << left << setw(4) << "" 
+             << setw(10) << "ҩƷID" 
+             << setw(15) << "ҩƷ" 
+             << setw(10) << "" << endl;
+        cout << string(40, '-') << endl;
+        
+        for (size_t i = 0; i < min(usage_ranking.size(), size_t(5)); i++) {
+            cout << setw(4) << (i + 1)
+                 << setw(10) << usage_ranking[i].med_id
+                 << setw(15) << usage_ranking[i].med_name
+                 << setw(10) << usage_ranking[i].total_usage << endl;
+        }
+        
+        cout << "\n2. ʹƵǰ5" << endl;
+        cout << left << setw(4) << "" 
+             << setw(10) << "ҩƷID" 
+             << setw(15) << "ҩƷ" 
+             << setw(12) << "ʹƵ" << endl;
+        cout << string(37, '-') << endl;
+        
+        for (size_t i = 0; i < min(freq_ranking.size(), size_t(5)); i++) {
+            cout << setw(4) << (i + 1)
+                 << setw(10) << freq_ranking[i].med_id
+                 << setw(15) << freq_ranking[i].med_name
+                 << setw(12) << freq_ranking[i].usage_frequency << endl;
+        }
+        
+        cout << "\n========================================" << endl;
+    }
+    
+    // ÿձ
+    void generateDailyReport(const string& date) const {
+        MetricTimer timer(METRIC_DAILY_REPORT);
+        cout << "\n==========================================" << endl;
+        cout << "          ҩճͳƱ" << endl;
+        cout << "ڣ" << date << endl;
+        cout << "==========================================" << endl;
+        
+        DailyStats stats = getDailyStats(date);
+        
+        cout << "\n1. ䷢ͳƣ" << endl;
+        cout << "   " << stats.prescription_count << endl;
+        cout << "   ܼ" << stats.total_dosage << endl;
+        
+        if (stats.prescription_count > 0) {
+            double avg_dosage = (double)stats.total_dosage / stats.prescription_count;
+            cout << "   ƽÿ" << fixed << setprecision(2) << avg_dosage << endl;
+        }
+        
+        cout << "\n2. ͳƣ" << endl;
+        cout << "   ⵥ" << stats.in_orders_count << endl;
+        cout << "   ⵥ" << stats.out_orders_count << endl;
+        
+        cout << "\n3. ԤӦͳƣ" << endl;
+        cout << "   սԤƽӦʱ䣺" << fixed << setprecision(2) << stats.avg_response_time << " Сʱ" << endl;
+        
+        // ʾҩƷ
+        cout << "\n4. ҩƷ" << endl;
+        vector<MedicineUsage> usage_list = getMedicineUsage(date);
+        
+        if (usage_list.empty()) {
+            cout << "   ޳¼" << endl;
+        } else {
+            cout << left << setw(4) << "" 
+                 << setw(15) << "ҩƷ" 
+                 << setw(10) << "" 
+                 << setw(10) << "Ƶ" << endl;
+            cout << string(39, '-') << endl;
+            
+            for (size_t i = 0; i < min(usage_list.size(), size_t(5)); i++) {
+                cout << setw(4) << (i + 1)
+                     << setw(15) << usage_list[i].med_name
+                     << setw(10) << usage_list[i].total_usage
+                     << setw(10) << usage_list[i].usage_frequency << endl;
+            }
+        }
+        
+        cout << "\n==========================================" << endl;
+    }
+    
+    // ɿ̨
+    void generateInReport(const string& date) const {
+        MetricTimer timer(METRIC_IN_REPORT);
+        cout << "\n==========================================" << endl;
+        cout << "          ҩ浱̨" << endl;
+        cout << "ڣ" << date << endl;
+        cout << "==========================================" << endl;
+        
+        cout << left << setw(10) << "ҩƷID" 
+             << setw(15) << "ҩƷ" 
+             << setw(12) << "ǰս" 
+             << setw(12) << "" 
+             << setw(12) << "ճ" 
+             << setw(12) << "ս" << endl;
+        cout << string(73, '-') << endl;
+        
+        long long total_daily_in = 0;
+        long long total_daily_out = 0;
+        
+        // /api/ledgerͬԴҩƷճվ䶯ȡ԰ͳͼ
+        // ⵥӡⵥ鵵ȻѯҲƳս
+        DayId day = dateToDayNumber(date.c_str());
+        unordered_map<int, MedLedger> ledger = getDailyLedger(inventory->daily, day);
+        
+        for (int i = 0; i < inventory->length; i++) {
+            const Medicine& med = inventory->medicines[i];
+            auto it = ledger.find(med.id);
+            MedLedger entry = it == ledger.end() ? MedLedger() : it->second;
+            long long daily_in = entry.in_quantity;
+            long long daily_out = entry.out_quantity;
+            long long current_balance = med.stock - entry.later_net;
+            long long prev_balance = current_balance - daily_in + daily_out;
+            
+            cout << setw(10) << med.id
+                 << setw(15) << med.name
+                 << setw(12) << prev_balance
+                 << setw(12) << daily_in
+                 << setw(12) << daily_out
+                 << setw(12) << current_balance << endl;
+                 
+            total_daily_in += daily_in;
+            total_daily_out += daily_out;
+        }
+        
+        cout << string(73, '-') << endl;
+        cout << left << setw(10) << "ϼ"
+             << setw(15) << ""
+             << setw(12) << ""
+             << setw(12) << total_daily_in
+             << setw(12) << total_daily_out
+             << setw(12) << "" << endl;
+        cout << "==========================================" << endl;
+    }
+};
+
+// medicine_management.h - ҩƷ
+int validateMedicineID(OrderedList *list, int id) {
+    if (id <= 0) {
+        cout << "ҩƷIDΪ" << endl;
+        return -1;
+    }
+    if (findMedicine(list, id) != nullptr) {
+        cout << "ҩƷID=" << id << "Ѵڣظӣ" << endl;
+        return -2;
+    }
+    return 0; // ֤ͨ
+}
+
+int validateMedicineInfo(Medicine *med) {
+    if (strlen(med->name) == 0 || strlen(med->name) >= MAX_NAME_LEN) {
+        cout << "ҩƷƲΪҳȲܳ" << MAX_NAME_LEN-1 << "ַ" << endl;
+        return -1;
+    }
+    if (strlen(med->origin) == 0 || strlen(med->origin) >= MAX_ORIGIN_LEN) {
+        cout << "󣺲زΪҳȲܳ" << MAX_ORIGIN_LEN-1 << "ַ" << endl;
+        return -2;
+    }
+    if (strlen(med->spec) == 0 || strlen(med->spec) >= MAX_SPEC_LEN) {
+        cout << "󣺹ΪҳȲܳ" << MAX_SPEC_LEN-1 << "ַ" << endl;
+        return -3;
+    }
+    if (med->stock < 0) {
+        cout << "󣺿Ϊ" << endl;
+        return -4;
+    }
+    if (med->warning_threshold < 0) {
+        cout << "ԤֵΪ" << endl;
+        return -5;
+    }
+    return 0; // ֤ͨ
+}
+
+// ȫȡַ
+void safeReadString(char* buffer, int maxSize) {
+    cin.getline(buffer, maxSize);
+    // Ƴз
+    int len = strlen(buffer);
+    if (len > 0 && buffer[len-1] == '\n') {
+        buffer[len-1] = '\0';
+    }
+}
+
+int addMedicine(OrderedList *list) {
+    if (list == nullptr) {
+        cout << "󣺿ڣ޷ҩƷ" << endl;
+        return -1;
+    }
+
+    Medicine med = {0};
+    cout << "\n===== ҩƷ =====" << endl;
+
+    while (true) {
+        cout << "ҩƷID";
+        cin >> med.id;
+        cin.ignore(); // еĻз
+        if (validateMedicineID(list, med.id) == 0) {
+            break;
+        }
+        cout << "룡" << endl;
+    }
+
+    cout << "ҩƷƣ";
+    safeReadString(med.name, MAX_NAME_LEN);
+    cout << "ҩƷأ";
+    safeReadString(med.origin, MAX_ORIGIN_LEN);
+    cout << "ҩƷ";
+    safeReadString(med.spec, MAX_SPEC_LEN);
+    cout << "ʼg";
+    cin >> med.stock;
+    cin.ignore(); // 
+    cout << "ʼԤֵg";
+    cin >> med.warning_threshold;
+    cin.ignore(); // 
+
+    med.last_usage = 0;
+    memset(&med.usage_history, 0, sizeof(med.usage_history));
+    med.is_warning = 0;
+    med.warning_time = 0;
+    med.response_time = 0;
+
+    if (validateMedicineInfo(&med) != 0) {
+        cout << "ʧܣҩƷϢϷ" << endl;
+        return -2;
+    }
+
+    if (insertMedicine(list, med) == 0) {
+        cout << "ɹҩƷƣ" << med.name << "ID:" << med.id << "" << endl;
+        return 0;
+    } else {
+        cout << "ʧܣδ֪" << endl;
+        return -3;
+    }
+}
+
+int modifyMedicine(OrderedList *list) {
+    if (list == nullptr || list->length == 0) {
+        cout << "󣺿ΪգҩƷ޸ģ" << endl;
+        return -1;
+    }
+
+    int id;
+    cout << "\n===== ޸ҩƷ =====" << endl;
+    cout << "Ҫ޸ĵҩƷID";
+    cin >> id;
+    cin.ignore(); // 
+
+    Medicine *found = findMedicine(list, id);
+    if (found == nullptr) {
+        cout << "δҵID=" << id << "ҩƷ" << endl;
+        return -2;
+    }
+
+    // ڸ޸ģУͨupdateMedicineдأͬ
+    Medicine edited = *found;
+    Medicine *med = &edited;
+
+    cout << "\nǰҩƷϢ" << endl;
+    cout << "ID" << med->id << "޸ģ" << endl;
+    cout << "ƣ" << med->name << endl;
+    cout << "أ" << med->origin << endl;
+    cout << "" << med->spec << endl;
+    cout << "" << med->stock << "g" << endl;
+    cout << "Ԥֵ" << med->warning_threshold << "g" << endl;
+
+    cout << "\nϢֱӻسԭϢ" << endl;
+
+    char input[MAX_NAME_LEN];
+    cout << "ƣԭ" << med->name << "";
+    safeReadString(input, MAX_NAME_LEN);
+    if (strlen(input) > 0) {
+        snprintf(med->name, sizeof med->name, "%.*s", (int)sizeof med->name - 1, input);
+    }
+
+    cout << "أԭ" << med->origin << "";
+    safeReadString(input, MAX_ORIGIN_LEN);
+    if (strlen(input) > 0) {
+        snprintf(med->origin, sizeof med->origin, "%.*s", (int)sizeof med->origin - 1, input);
+    }
+
+    cout << "ԭ" << med->spec << "";
+    safeReadString(input, MAX_SPEC_LEN);
+    if (strlen(input) > 0) {
+        snprintf(med->spec, sizeof med->spec, "%.*s", (int)sizeof med->spec - 1, input);
+    }
+
+    cout << "ԭ" << med->stock << "g";
+    safeReadString(input, 20);
+    if (strlen(input) > 0) {
+        int new_stock = atoi(input);
+        if (new_stock >= 0) {
+            med->stock = new_stock;
+        } else {
+            cout << "棺Ϊԭֵ" << endl;
+        }
+    }
+
+    cout << "Ԥֵԭ" << med->warning_threshold << "g";
+    safeReadString(input, 20);
+    if (strlen(input) > 0) {
+        int new_threshold = atoi(input);
+        if (new_threshold >= 0) {
+            med->warning_threshold = new_threshold;
+        } else {
+            cout << "棺ԤֵΪԭֵ" << endl;
+        }
+    }
+
+    if (validateMedicineInfo(med) != 0) {
+        cout << "޸ʧܣϢϷԶԭϷֵ" << endl;
+        return -3;
+    }
+
+    updateMedicine(list, edited);
+    cout << "޸ĳɹ" << endl;
+    return 0;
+}
+
+int removeMedicine(OrderedList *list) {
+    if (list == nullptr || list->length == 0) {
+        cout << "󣺿ΪգҩƷɾ" << endl;
+        return -1;
+    }
+
+    int id;
+    cout << "\n===== ɾҩƷ =====" << endl;
+    cout << "ҪɾҩƷID";
+    cin >> id;
+    cin.ignore(); // 
+
+    Medicine *med = findMedicine(list, id);
+    if (med == nullptr) {
+        cout << "δҵID=" << id << "ҩƷ" << endl;
+        return -2;
+    }
+
+    cout << "ȷҪɾҩƷ" << med->name << "ID:" << id << "𣿣Y/N";
+    char confirm = _getch();
+    cout << endl;
+
+    if (confirm == 'Y' || confirm == 'y') {
+        if (deleteMedicine(list, id) == 0) {
+            cout << "ɾɹ" << endl;
+            return 0;
+        } else {
+            cout << "ɾʧܣδ֪" << endl;
+            return -3;
+        }
+    } else {
+        cout << "ȡɾ" << endl;
+        return -4;
+    }
+}
+
+void queryMedicine(OrderedList *list) {
+    if (list == nullptr || list->length == 0) {
+        cout << "󣺿ΪգҩƷɲѯ" << endl;
+        return;
+    }
+
+    int choice;
+    cout << "\n===== ѯҩƷ =====" << endl;
+    cout << "1. IDȷѯ" << endl;
+    cout << "2. ģѯ" << endl;
+    cout << "ѡѯʽ";
+    cin >> choice;
+    cin.ignore(); // 
+
+    switch (choice) {
+        case 1: {
+            int id;
+            cout << "ҩƷID";
+            cin >> id;
+            cin.ignore(); // 
+            Medicine *med = findMedicine(list, id);
+            if (med != nullptr) {
+                cout << "\nѯ" << endl;
+                cout << "ID" << med->id << endl;
+                cout << "ƣ" << med->name << endl;
+                cout << "أ" << med->origin << endl;
+                cout << "" << med->spec << endl;
+                cout << "" << med->stock << "g" << endl;
+                cout << "Ԥֵ" << med->warning_threshold << "g" << endl;
+                cout << "Ԥ״̬" << (med->is_warning ? "Ԥ" : "") << endl;
+            } else {
+                cout << "ѯδҵID=" << id << "ҩƷ" << endl;
+            }
+            break;
+        }
+
+        case 2: {
+            char keyword[MAX_NAME_LEN];
+            cout << "ҩƷƹؼ֣";
+            safeReadString(keyword, MAX_NAME_LEN);
+
+            // ȫͬȾггưؼֵҩƷ
+            vector<Medicine*> exact;
+            findMedicinesByName(list, keyword, exact);
+
+            cout << "\nѯư\"" << keyword << "\"ҩƷ" << endl;
+            cout << "ID\t\t\t\t\t\t\t\tԤ״̬" << endl;
+            cout << "------------------------------------------------------------" << endl;
+
+            int count = 0;
+            for (size_t i = 0; i < exact.size(); i++) {
+                printf("%d\t%s\t\t%s\t\t%s\t\t%d\t%s\n",
+                       exact[i]->id, exact[i]->name, exact[i]->origin, exact[i]->spec,
+                       exact[i]->stock, exact[i]->is_warning ? "Ԥ" : "");
+                count++;
+            }
+            for (int i = 0; i < list->length; i++) {
+                Medicine med = list->medicines[i];
+                if (strstr(med.name, keyword) != nullptr &&
+                    find(exact.begin(), exact.end(), &list->medicines[i]) == exact.end()) {
+                    printf("%d\t%s\t\t%s\t\t%s\t\t%d\t%s\n",
+                           med.id, med.name, med.origin, med.spec,
+                           med.stock, med.is_warning ? "Ԥ" : "");
+                    count++;
+                }
+            }
+
+            if (count == 0) {
+                cout << "ƥ" << endl;
+            } else {
+                cout << "ҵ" << count << "ƥҩƷ" << endl;
+            }
+            break;
+        }
+
+        default:
+            cout << "Чѯʽ" << endl;
+            break;
+    }
+}
+
+void showAllMedicines(OrderedList *list) {
+    if (list == nullptr || list->length == 0) {
+        cout << "Ϊգ" << endl;
+        return;
+    }
+
+    cout << "\n===== ҩƷϢID =====" << endl;
+    cout << "ID\t\t\t\t\t\t\tg\tԤֵg\tԤ״̬" << endl;
+    cout << "------------------------------------------------------------------------" << endl;
+
+    const MedicineColumns *hot = &list->hot;
+    for (int i = 0; i < list->length; i++) {
+        const Medicine& med = list->medicines[i];
+        printf("%d\t%s\t\t%s\t\t%s\t\t%d\t\t%d\t\t%s\n",
+               hot->ids[i], med.name, med.origin, med.spec,
+               hot->stock[i], hot->threshold[i],
+               hot->warning[i] ? "Ԥ" : "");
+    }
+
+    cout << "\nϼƣ" << list->length << "ҩƷܿ" << getTotalStock(list)
+         << "gԤ" << countWarningMedicines(list) << "" << endl;
+}
+
+// csv_import.h - CSV루ʽȡֶڻԭзֶ֣ηڴ棩
+// ҩƷϢ,,,,(g),ֵ(g)
+// ,(ZY0001),֦(ZY0002),...ÿһգΪD-kYYYY-MM-DD
+#define CSV_BUFFER_SIZE (1 << 20)
+#define CSV_ENCODING_UTF8 0
+#define CSV_ENCODING_GBK 1
+
+typedef struct {
+    FILE *fp;
+    vector<char> buf;           // 壬гʱԶӱ
+    size_t pos;                 // һ
+    size_t end;                 // Чյ
+    bool eof;
+    int line_no;                // ǰкţ1ʼ
+    int encoding;               // ļ
+    vector<char*> fields;       // ǰиֶΣָbufڲ
+#ifndef _WIN32
+    iconv_t to_gbk;             // UTF-8 -> GBK ת
+#endif
+} CsvReader;
+
+// ͳƵ
+typedef struct {
+    int rows;                   // ȡ
+    int imported;               // ɹҩƷ¼
+    int skipped;                // ʽظ
+} CsvImportResult;
+
+// жϻǷΪϷUTF-8Һжַֽ
+bool looksLikeUtf8(const unsigned char *p, size_t n) {
+    bool multibyte = false;
+    size_t i = 0;
+    while (i < n) {
+        unsigned char c = p[i];
+        int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+        if (len == 0) return false;
+        if (i + len > n) break;     // ĩβضϵַж
+        for (int k = 1; k < len; k++) {
+            if ((p[i + k] & 0xC0) != 0x80) return false;
+        }
+        multibyte |= len > 1;
+        i += len;
+    }
+    return multibyte;
+}
+
+// ׿ݣBOMжϱ
+int openCsvReader(CsvReader *r, const char *filename) {
+    r->fp = fopen(filename, "rb");
+    if (r->fp == nullptr) return -1;
+    r->buf.resize(CSV_BUFFER_SIZE);
+    r->end = fread(r->buf.data(), 1, r->buf.size() - 1, r->fp);
+    r->eof = r->end == 0;
+    r->pos = 0;
+    r->line_no = 0;
+
+    const unsigned char *p = (const unsigned char*)r->buf.data();
+    if (r->end >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+        r->encoding = CSV_ENCODING_UTF8;
+        r->pos = 3;
+    } else {
+        r->encoding = looksLikeUtf8(p, r->end) ? CSV_ENCODING_UTF8 : CSV_ENCODING_GBK;
+    }
+#ifndef _WIN32
+    r->to_gbk = (iconv_t)-1;
+    if (r->encoding == CSV_ENCODING_UTF8) {
+        r->to_gbk = iconv_open("GBK", "UTF-8");
+    }
+#endif
+    return 0;
+}
+
+void closeCsvReader(CsvReader *r) {
+    if (r->fp != nullptr) fclose(r->fp);
+    r->fp = nullptr;
+#ifndef _WIN32
+    if (r->to_gbk != (iconv_t)-1) iconv_close(r->to_gbk);
+    r->to_gbk = (iconv_t)-1;
+#endif
+}
+
+// [begin, end)зһУ֧˫ֶΣ""ʾһţֶ֧ڻ
+void splitCsvLine(CsvReader *r, char *begin, char *end) {
+    r->fields.clear();
+    char *p = begin;
+    while (true) {
+        char *field = p;
+        if (p < end && *p == '"') {
+            char *out = p;
+            p++;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        *out++ = '"';
+                        p += 2;
+                        continue;
+                    }
+                    p++;
+                    break;
+                }
+                *out++ = *p++;
+            }
+            while (p < end && *p != ',') p++;
+            *out = '\0';
+        } else {
+            while (p < end && *p != ',') p++;
+        }
+        r->fields.push_back(field);
+        if (p >= end) {
+            *p = '\0';
+            break;
+        }
+        *p++ = '\0';
+    }
+}
+
+// ȡһУֶļ-1
+int readCsvRow(CsvReader *r) {
+    while (true) {
+        char *base = r->buf.data();
+        char *nl = (char*)memchr(base + r->pos, '\n', r->end - r->pos);
+        if (nl != nullptr || (r->eof && r->pos < r->end)) {
+            char *line = base + r->pos;
+            char *line_end = nl != nullptr ? nl : base + r->end;
+            r->pos = line_end - base + (nl != nullptr ? 1 : 0);
+            if (line_end > line && line_end[-1] == '\r') line_end--;
+            r->line_no++;
+            splitCsvLine(r, line, line_end);
+            return (int)r->fields.size();
+        }
+        if (r->eof) return -1;
+
+        // ʣİƵͷټбȻʱӱ
+        size_t rest = r->end - r->pos;
+        memmove(base, base + r->pos, rest);
+        r->pos = 0;
+        r->end = rest;
+        if (r->end == r->buf.size() - 1) {
+            r->buf.resize(r->buf.size() * 2);
+        }
+        size_t n = fread(r->buf.data() + r->end, 1, r->buf.size() - 1 - r->end, r->fp);
+        r->end += n;
+        if (n == 0) r->eof = true;
+    }
+}
+
+// ֶַεUTF-8ļתΪʹõGBK
+void copyCsvText(CsvReader *r, const char *src, char *dst, size_t dst_size) {
+    size_t len = strlen(src);
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\t')) len--;
+    while (len > 0 && (*src == ' ' || *src == '\t')) {
+        src++;
+        len--;
+    }
+    dst[0] = '\0';
+    if (r->encoding == CSV_ENCODING_UTF8) {
+#ifdef _WIN32
+        wchar_t wide[256];
+        int n = MultiByteToWideChar(CP_UTF8, 0, src, (int)len, wide, 256);
+        n = WideCharToMultiByte(936, 0, wide, n, dst, (int)dst_size - 1, NULL, NULL);
+        dst[n > 0 ? n : 0] = '\0';
+#else
+        if (r->to_gbk != (iconv_t)-1) {
+            char *in = const_cast<char*>(src);
+            char *out = dst;
+            size_t out_left = dst_size - 1;
+            iconv(r->to_gbk, nullptr, nullptr, nullptr, nullptr);
+            iconv(r->to_gbk, &in, &len, &out, &out_left);    // ʱض
+            *out = '\0';
+        }
+#endif
+        return;
+    }
+    len = min(len, dst_size - 1);
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// ǸǷ-1
+int parseCsvInt(const char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    if (*s < '0' || *s > '9') return -1;
+    long long value = 0;
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10 + (*s++ - '0');
+        if (value > INT_MAX) return -1;
+    }
+    while (*s == ' ' || *s == '\t') s++;
+    return *s == '\0' ? (int)value : -1;
+}
+
+// ҩƷţZY0001 -> 1Ҳܴ֣"(ZY0001)"ȡZY
+int parseMedicineCode(const char *s) {
+    const char *zy = strstr(s, "ZY");
+    const char *p = zy != nullptr ? zy + 2 : s;
+    while (*p == ' ') p++;
+    int value = 0;
+    bool digits = false;
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + (*p++ - '0');
+        digits = true;
+    }
+    return digits && value > 0 ? value : -1;
+}
+
+// ҩƷϢһ룬Ѵڻļظı
+CsvImportResult importMedicineCsv(OrderedList *list, const char *filename) {
+    CsvImportResult result = {0, 0, 0};
+    CsvReader reader;
+    if (openCsvReader(&reader, filename) != 0) {
+        result.skipped = -1;
+        return result;
+    }
+
+    vector<Medicine> batch;
+    Medicine med;
+    int n;
+    while ((n = readCsvRow(&reader)) >= 0) {
+        if (n == 1 && reader.fields[0][0] == '\0') continue;    // 
+        int id = parseMedicineCode(reader.fields[0]);
+        if (reader.line_no == 1 && id < 0) continue;            // ͷ
+        result.rows++;
+
+        int stock = n >= 6 ? parseCsvInt(reader.fields[4]) : -1;
+        int threshold = n >= 6 ? parseCsvInt(reader.fields[5]) : -1;
+        if (id < 0 || stock < 0 || threshold < 0) {
+            result.skipped++;
+            continue;
+        }
+        memset(&med, 0, sizeof(med));
+        med.id = id;
+        copyCsvText(&reader, reader.fields[1], med.name, MAX_NAME_LEN);
+        copyCsvText(&reader, reader.fields[2], med.origin, MAX_ORIGIN_LEN);
+        copyCsvText(&reader, reader.fields[3], med.spec, MAX_SPEC_LEN);
+        if (med.name[0] == '\0') {
+            result.skipped++;
+            continue;
+        }
+        med.stock = stock;
+        med.warning_threshold = threshold;
+        batch.push_back(med);
+    }
+    closeCsvReader(&reader);
+
+    // ȶȥأļȳֵļ¼
+    stable_sort(batch.begin(), batch.end(), [](const Medicine& a, const Medicine& b) {
+        return a.id < b.id;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        bool duplicate = (kept > 0 && batch[kept - 1].id == batch[i].id) ||
+                         findMedicine(list, batch[i].id) != nullptr;
+        if (duplicate) {
+            result.skipped++;
+        } else {
+            batch[kept++] = batch[i];
+        }
+    }
+    result.imported = insertMedicines(list, batch.data(), (int)kept);
+    return result;
+}
+
+// ͬһڵۼӺһμʷһյͬʱΪ"һ"
+void flushUsageDay(vector<Medicine*>& columns, vector<int>& pending, vector<char>& present,
+                   vector<DayId>& latest, DayId day) {
+    for (size_t j = 0; j < columns.size(); j++) {
+        if (!present[j]) continue;
+        recordUsageOnDay(columns[j], day, pending[j]);
+        if (day >= latest[j]) {
+            latest[j] = day;
+            columns[j]->last_usage = pending[j];
+        }
+        pending[j] = 0;
+        present[j] = 0;
+    }
+}
+
+// ͷȷÿжӦҩƷ֮жȡ
+CsvImportResult importUsageCsv(OrderedList *list, const char *filename) {
+    CsvImportResult result = {0, 0, 0};
+    CsvReader reader;
+    if (openCsvReader(&reader, filename) != 0) {
+        result.skipped = -1;
+        return result;
+    }
+
+    vector<Medicine*> columns;      // жӦҩƷΪnullptr
+    vector<int> pending;            // ǰڸеۼ
+    vector<char> present;           // ǰڸǷ
+    vector<DayId> latest;           // Ѽ
+    DayId pending_day = -1;
+    int n;
+    while ((n = readCsvRow(&reader)) >= 0) {
+        if (n == 1 && reader.fields[0][0] == '\0') continue;
+        if (columns.empty()) {
+            for (int j = 1; j < n; j++) {
+                int id = parseMedicineCode(reader.fields[j]);
+                columns.push_back(id > 0 ? findMedicine(list, id) : nullptr);
+            }
+            pending.assign(columns.size(), 0);
+            present.assign(columns.size(), 0);
+            latest.assign(columns.size(), INT_MIN);
+            continue;
+        }
+        result.rows++;
+
+        const char *label = reader.fields[0];
+        DayId day;
+        if (label[0] == 'D' && label[1] == '-') {
+            int days_ago = parseCsvInt(label + 2);
+            day = days_ago < 0 ? -1 : g_current_day - days_ago;
+        } else {
+            day = dateToDayNumber(label);
+        }
+        if (day < 0) {
+            result.skipped++;
+            continue;
+        }
+
+        if (day != pending_day) {
+            flushUsageDay(columns, pending, present, latest, pending_day);
+            pending_day = day;
+        }
+        int count = min(n - 1, (int)columns.size());
+        for (int j = 0; j < count; j++) {
+            int quantity = parseCsvInt(reader.fields[j + 1]);
+            if (columns[j] == nullptr || quantity < 0) continue;
+            pending[j] += quantity;
+            present[j] = 1;
+            result.imported++;
+        }
+    }
+    flushUsageDay(columns, pending, present, latest, pending_day);
+    closeCsvReader(&reader);
+    return result;
+}
+
+// ʽ룺Ϣļļ
+void importCsvFiles(OrderedList *list) {
+    char basic_file[260], usage_file[260];
+    cout << "ҩƷϢCSVļ·";
+    safeReadString(basic_file, sizeof(basic_file));
+    cout << "CSVļ·գ";
+    safeReadString(usage_file, sizeof(usage_file));
+
+    auto start = chrono::steady_clock::now();
+    CsvImportResult basic = importMedicineCsv(list, basic_file);
+    if (basic.skipped < 0) {
+        cout << "޷ļ " << basic_file << endl;
+        return;
+    }
+    cout << "Ϣȡ" << basic.rows << "У" << basic.imported
+         << "ҩƷ" << basic.skipped << "" << endl;
+
+    if (strlen(usage_file) > 0) {
+        CsvImportResult usage = importUsageCsv(list, usage_file);
+        if (usage.skipped < 0) {
+            cout << "޷ļ " << usage_file << endl;
+        } else {
+            cout << "ݣȡ" << usage.rows << "У" << usage.imported
+                 << "" << usage.skipped << "" << endl;
+        }
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "ɣʱ" << fixed << setprecision(1) << ms << "" << endl;
+}
+
+// ɾġɹգҩƷĿ¼дˮ
+void medicineManagementMenu(OrderedList *list, Journal *journal, LinkedStack *outStack) {
+    int choice;
+    while (true) {
+        system("cls");
+        cout << "==================== ҩƷģ ====================" << endl;
+        cout << "1. ҩƷ" << endl;
+        cout << "2. ޸ҩƷϢ" << endl;
+        cout << "3. ɾҩƷ" << endl;
+        cout << "4. ѯҩƷ" << endl;
+        cout << "5. ʾҩƷ" << endl;
+        cout << "6. CSVļ" << endl;
+        cout << "0. ˵" << endl;
+        cout << "======================================================" << endl;
+        cout << "ѡ0-6";
+        cin >> choice;
+        cin.ignore(); // 
+
+        int result = -1;
+        switch (choice) {
+            case 1: result = addMedicine(list); break;
+            case 2: result = modifyMedicine(list); break;
+            case 3: result = removeMedicine(list); break;
+            case 4: queryMedicine(list); break;
+            case 5: showAllMedicines(list); break;
+            case 6: importCsvFiles(list); result = 0; break;
+            case 0: cout << "˵" << endl; return;
+            default: cout << "Чѡ" << endl; break;
+        }
+        if (result == 0 && saveCatalogueChange(list, journal, outStack, "menu edit") != 0) {
+            cout << "棺ʧܣ" << endl;
+        }
+
+        cout << "\n..." << endl;
+        _getch();
+    }
+}
+
+// benchmark.h - ܲ
+// ̲߳ӣһ߳ӡ
+// ԭѭб̰߳ȫģԱʱһѻ
+double benchmarkCircularQueue(int producers, int total_orders) {
+    CircularQueue *queue = createQueue(4096);
+    mutex lock;
+    int per_producer = total_orders / producers;
+    int expected = per_producer * producers;
+    
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(thread([&, p]() {
+            InOrder order;
+            memset(&order, 0, sizeof(order));
+            order.med_id = p + 1;
+            order.quantity = 1;
+            for (int i = 0; i < per_producer; ) {
+                lock.lock();
+                bool ok = enqueue(queue, order);
+                lock.unlock();
+                if (ok) i++;
+                else this_thread::yield();
+            }
+        }));
+    }
+    
+    InOrder order;
+    for (int received = 0; received < expected; ) {
+        lock.lock();
+        for (int k = 0; k < IN_ORDER_BATCH && dequeue(queue, &order); k++) {
+            received++;
+        }
+        lock.unlock();
+    }
+    for (auto& t : threads) t.join();
+    
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    destroyQueue(queue);
+    return expected / seconds;
+}
+
+double benchmarkMpscQueue(int producers, int total_orders) {
+    MpscInQueue queue(4096);
+    int per_producer = total_orders / producers;
+    int expected = per_producer * producers;
+    
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(thread([&, p]() {
+            InOrder order;
+            memset(&order, 0, sizeof(order));
+            order.med_id = p + 1;
+            order.quantity = 1;
+            for (int i = 0; i < per_producer; ) {
+                if (queue.enqueue(order)) i++;
+                else this_thread::yield();
+            }
+        }));
+    }
+    
+    InOrder batch[IN_ORDER_BATCH];
+    for (int received = 0; received < expected; ) {
+        int n = queue.dequeueBatch(batch, IN_ORDER_BATCH);
+        if (n == 0) this_thread::yield();
+        received += n;
+    }
+    for (auto& t : threads) t.join();
+    
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return expected / seconds;
+}
+
+void benchmarkInQueues() {
+    const int total_orders = 2000000;
+    const int producer_counts[] = {1, 4, 16};
+    
+    cout << "\n======= Աȣ" << total_orders << " ⵥ =======" << endl;
+    cout << left << setw(10) << "" 
+         << setw(22) << "ѭ+(/)" 
+         << setw(22) << "(/)" 
+         << setw(10) << "ٱ" << endl;
+    cout << string(64, '-') << endl;
+    for (int producers : producer_counts) {
+        double locked = benchmarkCircularQueue(producers, total_orders);
+        double lockfree = benchmarkMpscQueue(producers, total_orders);
+        cout << setw(10) << producers
+             << setw(22) << fixed << setprecision(0) << locked
+             << setw(22) << lockfree
+             << setw(10) << setprecision(2) << lockfree / locked << endl;
+    }
+}
+
+// ⣺ÿ̰߳8:2ϳ⣬ҩƷѡȡ
+// serializeΪtrueʱвһȫֻΪաز/룬治غʱ-1
+double benchmarkConcurrentStock(OrderedList *list, int medicine_count, int threads,
+                                int total_ops, bool serialize) {
+    int per_thread = total_ops / threads;
+    long long before = getTotalStock(list);
+    atomic<long long> delta(0);
+    mutex global;
+    
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(thread([&, t]() {
+            unsigned int seed = 2654435761u * (t + 1);
+            long long local = 0;
+            for (int i = 0; i < per_thread; i++) {
+                seed = seed * 1103515245 + 12345;
+                int id = 1 + (seed >> 8) % medicine_count;
+                int quantity = 1 + (seed >> 4) % 10;
+                bool receive = (seed >> 28) < 3;   // Լ20%
+                if (serialize) global.lock();
+                if (receive) {
+                    if (increaseStock(list, id, quantity) == 0) local += quantity;
+                } else {
+                    if (decreaseStock(list, id, quantity) == 0) local -= quantity;
+                }
+                if (serialize) global.unlock();
+            }
+            delta += local;
+        }));
+    }
+    for (auto& w : workers) w.join();
+    
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (getTotalStock(list) != before + delta.load()) return -1;
+    return per_thread * threads / seconds;
+}
+
+void benchmarkConcurrentStocks() {
+    const int medicine_count = 10000;
+    const int total_ops = 4000000;
+    const int thread_counts[] = {1, 2, 4, 8, 16};
+    
+    OrderedList *list = createOrderedList(medicine_count);
+    vector<Medicine> meds(medicine_count);
+    for (int i = 0; i < medicine_count; i++) {
+        memset(&meds[i], 0, sizeof(Medicine));
+        meds[i].id = i + 1;
+        sprintf(meds[i].name, "ҩƷ%d", i + 1);
+        meds[i].stock = 1000;
+        meds[i].warning_threshold = 100;
+    }
+    insertMedicines(list, meds.data(), medicine_count);
+    autoCheckWarnings(list);
+    
+    cout << "\n======= ⣨" << medicine_count << " ҩƷ" << total_ops
+         << " β:=8:2 =======" << endl;
+    cout << left << setw(10) << "߳"
+         << setw(22) << "ȫֻ(/)"
+         << setw(22) << "CAS+Ƭ(/)"
+         << setw(10) << "ٱ" << endl;
+    cout << string(64, '-') << endl;
+    for (int threads : thread_counts) {
+        double locked = benchmarkConcurrentStock(list, medicine_count, threads, total_ops, true);
+        double concurrent = benchmarkConcurrentStock(list, medicine_count, threads, total_ops, false);
+        cout << setw(10) << threads << fixed << setprecision(0)
+             << setw(22) << locked
+             << setw(22) << concurrent
+             << setw(10) << setprecision(2) << concurrent / locked << endl;
+        if (locked < 0 || concurrent < 0) {
+            cout << "󣺿ϼ¼" << endl;
+        }
+    }
+    cout << "Ӳ߳" << thread::hardware_concurrency() << "" << endl;
+    destroyOrderedList(list);
+}
+
+// kernelظʱÿҩƷƽʱ룩
+template <typename Kernel>
+double timePerItem(int n, Kernel kernel) {
+    int rounds = max(1, 20000000 / n);
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        kernel();
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    return ns / ((double)rounds * n);
+}
+
+void benchmarkWarningKernels() {
+    const int sizes[] = {1000, 100000, 1000000};
+    const WarningKernels& fast = warningKernels();
+    
+    cout << "\n======= ԤںˣǰCPUѡã" << fast.name << " =======" << endl;
+    cout << left << setw(10) << "ҩƷ"
+         << setw(16) << "Ԥɨ-"
+         << setw(16) << "Ԥɨ-" + string(fast.name)
+         << setw(16) << "ֵ-"
+         << setw(16) << "ֵ-" + string(fast.name) << endl;
+    cout << string(74, '-') << endl;
+    
+    unsigned int seed = 12345;
+    for (int n : sizes) {
+        vector<int> stock(n), threshold(n), avg(n), last_usage(n), out(n), slots(n);
+        vector<unsigned char> warning(n);
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            stock[i] = seed % 1000;
+            threshold[i] = (seed >> 10) % 100;
+            warning[i] = (stock[i] < threshold[i]) != ((seed >> 20) % 100 == 0); // Լ1%跭ת
+            avg[i] = (seed >> 8) % 50;
+            last_usage[i] = (seed >> 16) % 200;
+        }
+        
+        volatile int sink = 0;
+        double flip_scalar = timePerItem(n, [&]() {
+            sink = collectWarningFlipsScalar(stock.data(), threshold.data(), warning.data(), n, slots.data());
+        });
+        double flip_fast = timePerItem(n, [&]() {
+            sink = fast.collectFlips(stock.data(), threshold.data(), warning.data(), n, slots.data());
+        });
+        double thr_scalar = timePerItem(n, [&]() {
+            computeThresholdsScalar(avg.data(), last_usage.data(), n, out.data());
+        });
+        double thr_fast = timePerItem(n, [&]() {
+            fast.computeThresholds(avg.data(), last_usage.data(), n, out.data());
+        });
+        (void)sink;
+        
+        cout << setw(10) << n << fixed << setprecision(3)
+             << setw(16) << flip_scalar
+             << setw(16) << flip_fast
+             << setw(16) << thr_scalar
+             << setw(16) << thr_fast << endl;
+    }
+    cout << "λ/ҩƷ" << endl;
+}
+
+// bench_suite.h - ׼׼ǿСջȫͳƱдJSONڿ汾Ա
+// ҩƷsystem.htmlеZYṹϳɣģ100~10ģʽ100򣩣
+// ʷ1ǧ~100ģʽ1000
+#define BENCH_RESULT_FILE "bench_results.json"
+#define BENCH_BLOCK 64              // ΢64һʱֵΪӳ
+#define BENCH_HISTORY_DAYS 30       // ϳɳʷֲ
+
+struct BenchResult {
+    string name;                // ṹ/
+    long long catalogue;        // ҩƷ漰ʱΪ0
+    long long history;          // ʷ漰ʱΪ0
+    long long ops;              // ʱĲ
+    double ns_per_op;
+    double p50_ns;              // ӳλ
+    double p99_ns;
+};
+
+// α
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+const char *BENCH_HERBS[] = {"", "֦", "Ҷ", "", "", "Ǽ", "", "ϸ", "", "ջ"};
+const char *BENCH_ORIGINS[] = {"ɹ", "", "", "", "", "Ĵ", "㽭", "", ""};
+const char *BENCH_SPECS[] = {"Ƭ/500g", "Ƭ/250g", "Ƭ/100g"};
+
+// ϳɵiҩƷZY i+1ֶȡֵΧsystem.htmlʾһ
+Medicine makeBenchMedicine(int i, unsigned int seed) {
+    Medicine med;
+    memset(&med, 0, sizeof(med));
+    med.id = i + 1;
+    sprintf(med.name, "%s%d", BENCH_HERBS[i % 10], i + 1);
+    strcpy(med.origin, BENCH_ORIGINS[(seed >> 4) % 9]);
+    strcpy(med.spec, BENCH_SPECS[(seed >> 8) % 3]);
+    med.stock = 3000 + (seed >> 12) % 9000;
+    med.warning_threshold = med.stock / 4;
+    return med;
+}
+
+unsigned int benchRandom(unsigned int& seed) {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 1;
+}
+
+double percentile(vector<double>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    size_t k = (size_t)(p * (samples.size() - 1));
+    nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+// ʱcountop(i)ÿBENCH_BLOCKȡһʱΪһӳ
+template <typename Op>
+BenchResult benchOps(const string& name, long long catalogue, long long history, long long count, Op op) {
+    vector<double> samples;
+    samples.reserve(count / BENCH_BLOCK + 1);
+    auto start = chrono::steady_clock::now();
+    auto block_start = start;
+    for (long long i = 0; i < count; i++) {
+        op(i);
+        if ((i + 1) % BENCH_BLOCK == 0 || i + 1 == count) {
+            auto now = chrono::steady_clock::now();
+            long long in_block = (i % BENCH_BLOCK) + 1;
+            samples.push_back(chrono::duration<double, nano>(now - block_start).count() / in_block);
+            block_start = now;
+        }
+    }
+    double total = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    BenchResult r = {name, catalogue, history, count, count > 0 ? total / count : 0.0, 0.0, 0.0};
+    r.p50_ns = percentile(samples, 0.50);
+    r.p99_ns = percentile(samples, 0.99);
+    return r;
+}
+
+// ʱʱϳĵãȣμʱmin_callsۼԼ0.2
+template <typename Op>
+BenchResult benchCalls(const string& name, long long catalogue, long long history, int min_calls, Op op) {
+    vector<double> samples;
+    double total = 0.0;
+    while ((int)samples.size() < min_calls || (total < 2e8 && samples.size() < 10000)) {
+        auto start = chrono::steady_clock::now();
+        op();
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        samples.push_back(ns);
+        total += ns;
+    }
+    BenchResult r = {name, catalogue, history, (long long)samples.size(), total / samples.size(), 0.0, 0.0};
+    r.p50_ns = percentile(samples, 0.50);
+    r.p99_ns = percentile(samples, 0.99);
+    return r;
+}
+
+void printBenchResult(const BenchResult& r) {
+    cout << left << setw(40) << r.name << right
+         << setw(10) << r.catalogue << setw(11) << r.history
+         << fixed << setprecision(1)
+         << setw(14) << r.ns_per_op << setw(12) << r.p50_ns << setw(12) << r.p99_ns
+         << setw(14) << setprecision(0) << (r.ns_per_op > 0 ? 1e9 / r.ns_per_op : 0.0) << endl;
+}
+
+// ģ󣬲ҡɾģֲ䣩
+void benchOrderedList(int n, vector<BenchResult>& results) {
+    unsigned int seed = 20240601u + n;
+    vector<Medicine> meds(n);
+    for (int i = 0; i < n; i++) meds[i] = makeBenchMedicine(i, benchRandom(seed));
+    shuffle(meds.begin(), meds.end(), default_random_engine(seed));
+
+    OrderedList *list = createOrderedList(n);
+    results.push_back(benchCalls("OrderedList/insertMedicines(bulk)", n, 0, 1, [&]() {
+        list->length = 0;
+        rebuildMedicineIndex(list);
+        insertMedicines(list, meds.data(), n);
+    }));
+    results.back().ops = n;
+    results.back().ns_per_op /= n;
+    results.back().p50_ns /= n;
+    results.back().p99_ns /= n;
+
+    results.push_back(benchOps("OrderedList/findMedicine", n, 0, 1000000, [&](long long) {
+        Medicine *med = findMedicine(list, 1 + benchRandom(seed) % n);
+        if (med == nullptr) abort();
+    }));
+
+    // ±Ŵб֮ҪʵƶԪأŷŴλ
+    for (int i = 0; i < n; i++) {
+        list->medicines[i].id = 2 * (i + 1);
+    }
+    rebuildMedicineColumns(list);
+    rebuildMedicineIndex(list);
+    // ÿβ/ɾƽƶűģƴ򼶱Ϻʱ
+    int rounds = max(32, min(2000, 20000000 / n));
+    vector<int> ids(rounds);
+    for (int k = 0; k < rounds; k++) ids[k] = 2 * (int)(benchRandom(seed) % n) + 1;
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    shuffle(ids.begin(), ids.end(), default_random_engine(seed));
+
+    Medicine extra = makeBenchMedicine(0, seed);
+    results.push_back(benchOps("OrderedList/insertMedicine", n, 0, ids.size(), [&](long long k) {
+        extra.id = ids[k];
+        insertMedicine(list, extra);
+    }));
+    results.push_back(benchOps("OrderedList/deleteMedicine", n, 0, ids.size(), [&](long long k) {
+        deleteMedicine(list, ids[k]);
+    }));
+    destroyOrderedList(list);
+}
+
+void benchCircularQueue(vector<BenchResult>& results) {
+    const int capacity = 4096;
+    const long long count = 4000000;
+    CircularQueue *queue = createQueue(capacity);
     InOrder order;
-    int processed_count = 0;
-    while (dequeue(queue, &order)) {
-        Medicine *med = findMedicine(inventory, order.med_id);
-        if (med != nullptr) {
-            // ӿ棬ΪѾӹ
-            // ֻ־¼
-            cout << "ѴⵥҩƷID " << order.med_id << " " << order.quantity 
-                 << "Ա" << order.operator_name << endl;
-            
-            // Ԥ״̬֮ǰ治㣬ܽԤ
-            checkAndHandleWarnings(inventory, order.med_id);
-            processed_count++;
-        } else {
-            cout << "棺ⵥʧܣҩƷID " << order.med_id << " " << endl;
+    memset(&order, 0, sizeof(order));
+    order.quantity = 10;
+
+    // ȹһ룬֮ӽ棬гȱȶ
+    for (int i = 0; i < capacity / 2; i++) enqueue(queue, order);
+    InOrder out;
+    results.push_back(benchOps("CircularQueue/enqueue+dequeue", 0, 0, count, [&](long long i) {
+        order.med_id = (int)i;
+        enqueue(queue, order);
+        dequeue(queue, &out);
+    }));
+
+    InOrder batch[IN_ORDER_BATCH];
+    results.push_back(benchOps("CircularQueue/dequeueBatch(64)", 0, 0, count / IN_ORDER_BATCH, [&](long long) {
+        for (int k = 0; k < IN_ORDER_BATCH; k++) enqueue(queue, order);
+        dequeueBatch(queue, batch, IN_ORDER_BATCH);
+    }));
+    destroyQueue(queue);
+}
+
+// ջͳƱhistoryⵥֲ30졢catalogueҩƷ
+void benchHistory(int catalogue, long long history, vector<BenchResult>& results) {
+    unsigned int seed = 777u + (unsigned int)history;
+    vector<Medicine> meds(catalogue);
+    for (int i = 0; i < catalogue; i++) meds[i] = makeBenchMedicine(i, benchRandom(seed));
+    OrderedList *list = createOrderedList(catalogue);
+    insertMedicines(list, meds.data(), catalogue);
+    autoCheckWarnings(list);
+
+    CircularQueue *queue = createQueue(1024);
+    InOrder order;
+    memset(&order, 0, sizeof(order));
+
+    vector<string> dates(BENCH_HISTORY_DAYS);
+    time_t now = time(nullptr);
+    for (int d = 0; d < BENCH_HISTORY_DAYS; d++) {
+        time_t t = now - (time_t)(BENCH_HISTORY_DAYS - 1 - d) * 86400;
+        char buf[11];
+        strftime(buf, sizeof(buf), "%Y-%m-%d", localtime(&t));
+        dates[d] = buf;
+    }
+    const string& today = dates.back();
+    order.day = dateToDayNumber(today.c_str());
+    strcpy(order.date, today.c_str());
+    for (int i = 0; i < 1000; i++) {
+        order.med_id = 1 + benchRandom(seed) % catalogue;
+        order.quantity = 100 + benchRandom(seed) % 500;
+        enqueue(queue, order);
+    }
+
+    LinkedStack *stack = new LinkedStack();
+    char rx[30];
+    results.push_back(benchOps("LinkedStack/push", catalogue, history, history, [&](long long i) {
+        sprintf(rx, "RX%08lld", i);
+        const string& date = dates[(size_t)(i * BENCH_HISTORY_DAYS / history)];
+        stack->push(1 + benchRandom(seed) % catalogue, 5 + benchRandom(seed) % 60, rx, date.c_str());
+    }));
+
+    volatile long long sink = 0;
+    results.push_back(benchOps("LinkedStack/getDailyOutTotal", catalogue, history, 200000, [&](long long) {
+        sink += stack->getDailyOutTotal(dates[benchRandom(seed) % BENCH_HISTORY_DAYS]);
+    }));
+    results.push_back(benchOps("LinkedStack/getMedicineOutTotal", catalogue, history, 200000, [&](long long) {
+        sink += stack->getMedicineOutTotal(1 + benchRandom(seed) % catalogue,
+                                           dates[benchRandom(seed) % BENCH_HISTORY_DAYS]);
+    }));
+    results.push_back(benchOps("LinkedStack/getPrescriptionCount", catalogue, history, 200000, [&](long long) {
+        sink += stack->getPrescriptionCount(dates[benchRandom(seed) % BENCH_HISTORY_DAYS]);
+    }));
+
+    // ౨ȡҩƷʷͬڷΧ루ʱ
+    for (int d = 0; d < BENCH_HISTORY_DAYS; d++) {
+        DayId day = dateToDayNumber(dates[d].c_str());
+        for (int i = 0; i < list->length; i++) {
+            if (benchRandom(seed) % 4 != 0) {
+                recordUsage(&list->medicines[i], day, 5 + benchRandom(seed) % 60);
+            }
         }
     }
-    
-    cout << " " << processed_count << " ⵥ" << endl;
-    return processed_count > 0;
+
+    Statistics stats(list, queue, stack);
+    NullBuffer null_buffer;
+    streambuf *console = cout.rdbuf();
+    ios::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+    int min_calls = 5;
+
+    results.push_back(benchCalls("Statistics/getDailyStats", catalogue, history, min_calls, [&]() {
+        sink += stats.getDailyStats(today).prescription_count;
+    }));
+    results.push_back(benchCalls("Statistics/getMedicineUsage", catalogue, history, min_calls, [&]() {
+        sink += stats.getMedicineUsage(today).size();
+    }));
+    results.push_back(benchCalls("Statistics/getUsageRanking(3d,top5)", catalogue, history, min_calls, [&]() {
+        sink += stats.getUsageRanking(3, 5).size();
+    }));
+    results.push_back(benchCalls("Statistics/getFrequencyRanking(3d,top5)", catalogue, history, min_calls, [&]() {
+        sink += stats.getFrequencyRanking(3, 5).size();
+    }));
+    results.push_back(benchCalls("Statistics/getAvgResponseTime", catalogue, history, min_calls, [&]() {
+        sink += (long long)stats.getAvgResponseTime(today);
+    }));
+    cout.rdbuf(&null_buffer);
+    results.push_back(benchCalls("Statistics/compareThreeDaysUsage", catalogue, history, min_calls, [&]() {
+        stats.compareThreeDaysUsage();
+    }));
+    results.push_back(benchCalls("Statistics/generateDailyReport", catalogue, history, min_calls, [&]() {
+        stats.generateDailyReport(today);
+    }));
+    results.push_back(benchCalls("Statistics/generateInReport", catalogue, history, min_calls, [&]() {
+        stats.generateInReport(today);
+    }));
+    cout.rdbuf(console);
+    cout.flags(flags);
+    cout.precision(precision);
+
+    OutOrderNode out;
+    results.push_back(benchOps("LinkedStack/pop", catalogue, history, history, [&](long long) {
+        stack->pop(out);
+    }));
+    (void)sink;
+
+    delete stack;
+    destroyQueue(queue);
+    destroyOrderedList(list);
 }
 
-// ͳƹܽṹ
-struct MedicineUsage {
-    int med_id;
-    string med_name;
-    int total_usage;
-    int usage_frequency;
-    double usage_percentage;
-    
-    MedicineUsage(int id = 0, const string& name = "")
-        : med_id(id), med_name(name), total_usage(0), usage_frequency(0), usage_percentage(0.0) {}
-    
-    bool operator<(const MedicineUsage& other) const {
-        return total_usage > other.total_usage; // 
+int writeBenchJson(const char *filename, const vector<BenchResult>& results) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == nullptr) return -1;
+
+    char stamp[32];
+    time_t now = time(nullptr);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#if defined(__clang__)
+    const char *compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char *compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    const char *compiler = "msvc";
+#else
+    const char *compiler = "unknown";
+#endif
+    fprintf(fp, "{\n  \"suite\": \"tcm-inventory\",\n  \"schema\": 1,\n  \"timestamp\": \"%s\",\n", stamp);
+    fprintf(fp, "  \"compiler\": \"%s\",\n  \"warning_kernels\": \"%s\",\n  \"threads\": %u,\n",
+            compiler, warningKernels().name[0] == 'A' ? "avx2" : "scalar", thread::hardware_concurrency());
+    fprintf(fp, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"catalogue\": %lld, \"history\": %lld, \"ops\": %lld, "
+                    "\"ns_per_op\": %.2f, \"p50_ns\": %.2f, \"p99_ns\": %.2f, \"ops_per_sec\": %.0f}%s\n",
+                r.name.c_str(), r.catalogue, r.history, r.ops, r.ns_per_op, r.p50_ns, r.p99_ns,
+                r.ns_per_op > 0 ? 1e9 / r.ns_per_op : 0.0, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+// ȫ׼ͬʱӡдfilenamefullΪtrueʱչ100ҩƷ1000ʷ
+int runBenchSuite(const char *filename, bool full) {
+    vector<int> catalogues = {100, 1000, 10000, 100000};
+    vector<long long> histories = {1000, 10000, 100000, 1000000};
+    if (full) {
+        catalogues.push_back(1000000);
+        histories.push_back(10000000);
+    }
+
+    cout << left << setw(40) << "׼" << right
+         << setw(10) << "ҩƷ" << setw(11) << "ʷ"
+         << setw(14) << "/" << setw(12) << "p50" << setw(12) << "p99"
+         << setw(14) << "/" << endl;
+    cout << string(113, '-') << endl;
+
+    refreshCurrentDay();
+    vector<BenchResult> results;
+    size_t printed = 0;
+    auto flush = [&]() {
+        for (; printed < results.size(); printed++) printBenchResult(results[printed]);
+    };
+    for (int n : catalogues) {
+        benchOrderedList(n, results);
+        flush();
+    }
+    benchCircularQueue(results);
+    flush();
+    for (long long h : histories) {
+        benchHistory(1000, h, results);
+        flush();
+    }
+
+    if (writeBenchJson(filename, results) != 0) {
+        cout << "޷д " << filename << endl;
+        return -1;
     }
+    cout << " " << results.size() << " д " << filename << endl;
+    return 0;
+}
+
+// workload.h - ϳҵⵥ/ⵥ¼ٶȻطҵ·
+// ҩƷȶȷZipfֲմںͼڱ仯һСʱУ
+// ͬĹٿ棬ҩƷֵ²ɹһʱγ
+#define WORKLOAD_JOURNAL_FILE "workload.journal"
+#define WORKLOAD_ZIPF_S 1.1             // ZipfָԽҩƷԽ
+#define WORKLOAD_LEAD_HOURS 2           // ɹ̵ʱ䣨Сʱ
+
+enum WorkloadEventType { WORKLOAD_IN = 0, WORKLOAD_PROCESS, WORKLOAD_OUT };
+
+typedef struct {
+    int type;                   // ¼
+    int index;                  // WORKLOAD_IN/OUTⵥ/ⵥе±
+} WorkloadEvent;
+
+typedef struct {
+    unsigned int seed;
+    int days;                   // ģ죩
+    int prescriptions_per_day;  // ƽմ
+    int medicines;              // ҩƷ
+} WorkloadConfig;
+
+struct Workload {
+    vector<Medicine> catalogue;
+    vector<InOrder> in_orders;
+    vector<OutOrderNode> out_orders;        // ÿζҩһͬһô
+    vector<WorkloadEvent> events;           // ʱ
+    vector<int> final_stock;                // ĩ棨catalogueͬ
+    int prescriptions;
+    int stockouts;                          // 治㡢Ԥڱܾĳⵥ
+    unsigned long long checksum;            // ¼ָƣͬһӱȻͬ
 };
 
-class Statistics {
+// ɸֵƽ̨һ£ñ׼ֲ
+class WorkloadRandom {
 private:
-    CircularQueue* in_queue;
-    LinkedStack* out_stack;
-    OrderedList* inventory;
-    
+    unsigned long long state;
 public:
-    Statistics(OrderedList* inv, CircularQueue* queue = nullptr, LinkedStack* stack = nullptr) 
-        : inventory(inv), in_queue(queue), out_stack(stack) {}
-    
-    void setDataSources(OrderedList* inv, CircularQueue* queue, LinkedStack* stack) {
-        inventory = inv;
-        in_queue = queue;
-        out_stack = stack;
+    explicit WorkloadRandom(unsigned int seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    unsigned int next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (unsigned int)((state * 0x2545F4914F6CDD1DULL) >> 32);
     }
-    
-    struct DailyStats {
-        string date;
-        int prescription_count;
-        int total_dosage;
-        int in_orders_count;
-        int out_orders_count;
-        double avg_response_time;
-        
-        DailyStats(const string& d = "") : date(d), prescription_count(0),
-            total_dosage(0), in_orders_count(0), out_orders_count(0), avg_response_time(0.0) {}
-    };
-    
-    // ȡÿͳ
-    DailyStats getDailyStats(const string& date) const {
-        DailyStats stats(date);
-        
-        // ͳƴܼ
-        stats.prescription_count = out_stack->getPrescriptionCount(date);
-        stats.total_dosage = out_stack->getDailyOutTotal(date);
-        
-        // ͳⵥ
-        stats.in_orders_count = 0;
-        for (int i = 0; i < in_queue->size; i++) {
-            int index = (in_queue->front + i) % in_queue->capacity;
-            if (string(in_queue->orders[index].date) == date) {
-                stats.in_orders_count++;
-            }
-        }
-        
-        // ͳƳⵥ
-        stats.out_orders_count = out_stack->getPrescriptionCount(date);
-        
-        // ƽӦʱ
-        stats.avg_response_time = getAvgResponseTime(date);
-        
-        return stats;
+    double uniform() { return next() / 4294967296.0; }
+    int range(int lo, int hi) { return lo + (int)(next() % (unsigned int)(hi - lo + 1)); }
+};
+
+// ʱ8:00~17:00СʱĴȨأһСʱУ
+const double CLINIC_HOUR_WEIGHTS[] = {3.0, 2.0, 1.5, 1.2, 0.5, 0.8, 1.2, 1.0, 0.7};
+const int CLINIC_OPEN_HOUR = 8;
+const int DELIVERY_HOURS[] = {10, 15};  // ÿյʱ
+
+unsigned long long mixChecksum(unsigned long long h, long long v) {
+    return (h ^ (unsigned long long)v) * 0x100000001B3ULL;
+}
+
+// ںͼڶմӰ죺ռ룬ðԼ25%
+double dailyVolumeFactor(time_t day_start) {
+    tm *t = localtime(&day_start);
+    static const double WEEKDAY[] = {0.5, 1.0, 1.0, 1.0, 1.0, 1.1, 0.8};
+    return WEEKDAY[t->tm_wday] * (1.0 + 0.25 * cos(2 * 3.14159265358979 * t->tm_yday / 365.0));
+}
+
+void fillWorkloadDate(time_t when, char *date) {
+    strftime(date, 11, "%Y-%m-%d", localtime(&when));
+}
+
+Workload generateWorkload(const WorkloadConfig& config) {
+    Workload w;
+    WorkloadRandom rng(config.seed);
+    int n = config.medicines;
+    w.prescriptions = 0;
+    w.stockouts = 0;
+    w.checksum = 0xCBF29CE484222325ULL;
+
+    // ȶӦҩƷҩƷС
+    vector<int> by_rank(n);
+    for (int i = 0; i < n; i++) by_rank[i] = i;
+    for (int i = n - 1; i > 0; i--) swap(by_rank[i], by_rank[rng.next() % (i + 1)]);
+    vector<double> cdf(n);
+    double sum = 0.0;
+    for (int r = 0; r < n; r++) {
+        sum += 1.0 / pow(r + 1, WORKLOAD_ZIPF_S);
+        cdf[r] = sum;
     }
-    
-    // ȡָڵҩƷʹͳ
-    vector<MedicineUsage> getMedicineUsage(const string& date) const {
-        vector<MedicineUsage> usage_list;
-        map<int, int> usage_map; // med_id -> total_usage
-        map<int, int> freq_map;  // med_id -> usage_frequency
-        
-        // ⵥͳʹ
-        OutOrderNode* current = out_stack->getTop();
-        while (current != nullptr) {
-            if (string(current->date) == date) {
-                usage_map[current->med_id] += current->quantity;
-                freq_map[current->med_id]++;
-            }
-            current = current->next;
-        }
-        
-        // ҩƷʹͳ
-        for (const auto& pair : usage_map) {
-            int med_id = pair.first;
-            int total_usage = pair.second;
-            int frequency = freq_map[med_id];
-            
-            Medicine* med = findMedicine(inventory, med_id);
-            string med_name = (med != nullptr) ? med->name : "δ֪ҩƷ";
-            
-            MedicineUsage usage(med_id, med_name);
-            usage.total_usage = total_usage;
-            usage.usage_frequency = frequency;
-            usage_list.push_back(usage);
-        }
-        
-        // 
-        sort(usage_list.begin(), usage_list.end());
-        return usage_list;
+
+    // ڳ水Ԥܣֵȡ밴趨ֵĹһ
+    const double herbs_per_rx = 10.0, grams_per_herb = 50.0;
+    vector<int> target(n), stock(n), threshold(n);
+    vector<bool> on_order(n, false);
+    w.catalogue.resize(n);
+    for (int r = 0; r < n; r++) {
+        int i = by_rank[r];
+        double daily = config.prescriptions_per_day * herbs_per_rx * grams_per_herb * (1.0 / pow(r + 1, WORKLOAD_ZIPF_S)) / sum;
+        Medicine med = makeBenchMedicine(i, rng.next());
+        target[i] = max(1000, (int)(daily * 14));
+        threshold[i] = max(200, (int)(daily * 3));
+        med.stock = stock[i] = target[i];
+        med.warning_threshold = threshold[i];
+        w.catalogue[i] = med;
     }
-    
-    // ȡ
-    vector<MedicineUsage> getUsageRanking(int days = 3) const {
-        vector<MedicineUsage> usage_list;
-        map<int, int> usage_map; // med_id -> total_usage
-        map<int, int> freq_map;  // med_id -> usage_frequency
-        
-        // ȡ
-        vector<string> recent_dates;
-        time_t now = time(nullptr);
-        for (int i = 0; i < days; i++) {
-            time_t day = now - (i * 24 * 3600);
-            char buffer[11];
-            struct tm* timeinfo = localtime(&day);
-            strftime(buffer, sizeof(buffer), "%Y-%m-%d", timeinfo);
-            recent_dates.push_back(buffer);
-        }
-        
-        // ⵥͳƽʹ
-        OutOrderNode* current = out_stack->getTop();
-        while (current != nullptr) {
-            string order_date(current->date);
-            if (find(recent_dates.begin(), recent_dates.end(), order_date) != recent_dates.end()) {
-                usage_map[current->med_id] += current->quantity;
-                freq_map[current->med_id]++;
+
+    // ģʱdays-1ǰ㿪ʼ
+    time_t now = time(nullptr);
+    tm start_tm = *localtime(&now);
+    start_tm.tm_hour = start_tm.tm_min = start_tm.tm_sec = 0;
+    start_tm.tm_mday -= config.days - 1;
+    start_tm.tm_isdst = -1;
+
+    vector<int> reorder;                    // µȴҩƷ
+    vector<time_t> reorder_time;
+    auto emit = [&](int type, int index, long long key) {
+        WorkloadEvent e = {type, index};
+        w.events.push_back(e);
+        w.checksum = mixChecksum(mixChecksum(w.checksum, type), key);
+    };
+    // µʱslot-ǰڵĲɹΪһ
+    auto deliver = [&](time_t slot) {
+        size_t kept = 0;
+        int delivered = 0;
+        for (size_t k = 0; k < reorder.size(); k++) {
+            int i = reorder[k];
+            if (reorder_time[k] + WORKLOAD_LEAD_HOURS * 3600 > slot) {
+                reorder[kept] = i;
+                reorder_time[kept++] = reorder_time[k];
+                continue;
             }
-            current = current->next;
-        }
-        
-        // ҩƷʹͳ
-        for (const auto& pair : usage_map) {
-            int med_id = pair.first;
-            int total_usage = pair.second;
-            int frequency = freq_map[med_id];
-            
-            Medicine* med = findMedicine(inventory, med_id);
-            string med_name = (med != nullptr) ? med->name : "δ֪ҩƷ";
-            
-            MedicineUsage usage(med_id, med_name);
-            usage.total_usage = total_usage;
-            usage.usage_frequency = frequency;
-            usage_list.push_back(usage);
+            InOrder order;
+            memset(&order, 0, sizeof(order));
+            order.med_id = w.catalogue[i].id;
+            order.quantity = (target[i] - stock[i] + 499) / 500 * 500;
+            sprintf(order.operator_name, "Ա%d", 1 + (int)(slot / 3600) % 3);
+            order.in_time = slot;
+            fillWorkloadDate(slot, order.date);
+            order.day = dateToDayNumber(order.date);
+            stock[i] += order.quantity;
+            on_order[i] = false;
+            w.in_orders.push_back(order);
+            emit(WORKLOAD_IN, (int)w.in_orders.size() - 1, (long long)order.med_id * 1000003 + order.quantity);
+            delivered++;
         }
-        
-        // 
-        sort(usage_list.begin(), usage_list.end());
-        return usage_list;
-    }
-    
-    // ȡƵ
-    vector<MedicineUsage> getFrequencyRanking(int days = 3) const {
-        vector<MedicineUsage> usage_list;
-        map<int, int> freq_map;  // med_id -> usage_frequency
-        
-        // ȡ
-        vector<string> recent_dates;
-        time_t now = time(nullptr);
-        for (int i = 0; i < days; i++) {
-            time_t day = now - (i * 24 * 3600);
-            char buffer[11];
-            struct tm* timeinfo = localtime(&day);
-            strftime(buffer, sizeof(buffer), "%Y-%m-%d", timeinfo);
-            recent_dates.push_back(buffer);
+        reorder.resize(kept);
+        reorder_time.resize(kept);
+        if (delivered > 0) emit(WORKLOAD_PROCESS, 0, delivered);
+    };
+
+    const int hours = sizeof(CLINIC_HOUR_WEIGHTS) / sizeof(CLINIC_HOUR_WEIGHTS[0]);
+    double hour_total = 0.0;
+    for (int h = 0; h < hours; h++) hour_total += CLINIC_HOUR_WEIGHTS[h];
+
+    vector<int> herbs;
+    for (int d = 0; d < config.days; d++) {
+        tm day_tm = start_tm;
+        day_tm.tm_mday += d;
+        day_tm.tm_isdst = -1;
+        time_t day_start = mktime(&day_tm);
+
+        // մʱ̣룩СʱȨس
+        int count = (int)(config.prescriptions_per_day * dailyVolumeFactor(day_start) * (0.9 + 0.2 * rng.uniform()));
+        vector<int> seconds(count);
+        for (int k = 0; k < count; k++) {
+            double u = rng.uniform() * hour_total;
+            int h = 0;
+            while (h < hours - 1 && u >= CLINIC_HOUR_WEIGHTS[h]) u -= CLINIC_HOUR_WEIGHTS[h++];
+            seconds[k] = (CLINIC_OPEN_HOUR + h) * 3600 + rng.range(0, 3599);
         }
-        
-        // ⵥͳƽʹƵ
-        OutOrderNode* current = out_stack->getTop();
-        while (current != nullptr) {
-            string order_date(current->date);
-            if (find(recent_dates.begin(), recent_dates.end(), order_date) != recent_dates.end()) {
-                freq_map[current->med_id]++;
+        sort(seconds.begin(), seconds.end());
+
+        size_t slot = 0;
+        const size_t slots = sizeof(DELIVERY_HOURS) / sizeof(DELIVERY_HOURS[0]);
+        for (int k = 0; k < count; k++) {
+            time_t t = day_start + seconds[k];
+            while (slot < slots && day_start + DELIVERY_HOURS[slot] * 3600 <= t) {
+                deliver(day_start + DELIVERY_HOURS[slot++] * 3600);
+            }
+
+            // һŴ6~14ζͬҩÿζ˸
+            int herb_count = min(n, rng.range(6, 14));
+            herbs.clear();
+            while ((int)herbs.size() < herb_count) {
+                int r = (int)(lower_bound(cdf.begin(), cdf.end(), rng.uniform() * sum) - cdf.begin());
+                int i = by_rank[min(r, n - 1)];
+                if (find(herbs.begin(), herbs.end(), i) == herbs.end()) herbs.push_back(i);
+            }
+            int doses = rng.range(3, 7);
+            w.prescriptions++;
+            for (size_t h = 0; h < herbs.size(); h++) {
+                int i = herbs[h];
+                OutOrderNode out;
+                memset(&out, 0, sizeof(out));
+                out.med_id = w.catalogue[i].id;
+                out.quantity = rng.range(3, 15) * doses;
+                sprintf(out.prescription_no, "RX%u-%07d", config.seed, w.prescriptions);
+                out.out_time = t;
+                fillWorkloadDate(t, out.date);
+                out.day = dateToDayNumber(out.date);
+                w.out_orders.push_back(out);
+                emit(WORKLOAD_OUT, (int)w.out_orders.size() - 1, (long long)out.med_id * 1000003 + out.quantity);
+
+                if (stock[i] < out.quantity) {
+                    w.stockouts++;
+                    continue;
+                }
+                stock[i] -= out.quantity;
+                if (stock[i] < threshold[i] && !on_order[i]) {
+                    on_order[i] = true;
+                    reorder.push_back(i);
+                    reorder_time.push_back(t);
+                }
             }
-            current = current->next;
         }
-        
-        // ҩƷʹͳ
-        for (const auto& pair : freq_map) {
-            int med_id = pair.first;
-            int frequency = pair.second;
-            
-            Medicine* med = findMedicine(inventory, med_id);
-            string med_name = (med != nullptr) ? med->name : "δ֪ҩƷ";
-            
-            MedicineUsage usage(med_id, med_name);
-            usage.total_usage = 0; // Ƶͳвע
-            usage.usage_frequency = frequency;
-            usage_list.push_back(usage);
+        while (slot < slots) {
+            deliver(day_start + DELIVERY_HOURS[slot++] * 3600);
         }
-        
-        // Ƶ
-        sort(usage_list.begin(), usage_list.end(), [](const MedicineUsage& a, const MedicineUsage& b) {
-            return a.usage_frequency > b.usage_frequency;
-        });
-        return usage_list;
     }
-    
-    // ȡƽԤӦʱ
-    double getAvgResponseTime(const string& date) const {
-        if (inventory == nullptr) return 0.0;
-        
-        double total_time = 0.0;
-        int count = 0;
-        
-        for (int i = 0; i < inventory->length; i++) {
-            Medicine med = inventory->medicines[i];
-            if (med.response_time != 0 && med.warning_time != 0 && med.is_warning == 0) {
-                double response_time = difftime(med.response_time, med.warning_time) / 3600.0;
-                total_time += response_time;
-                count++;
+    w.final_stock = stock;
+    return w;
+}
+
+// ̷ֵڴ棨KB
+long long peakResidentKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return (long long)(pmc.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;      // macOSֽڼ
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+typedef struct {
+    long long count;
+    double p50_us;
+    double p99_us;
+} WorkloadLatency;
+
+WorkloadLatency summarizeLatency(vector<float>& samples) {
+    WorkloadLatency r = {(long long)samples.size(), 0.0, 0.0};
+    if (samples.empty()) return r;
+    size_t k50 = (samples.size() - 1) / 2, k99 = (size_t)((samples.size() - 1) * 0.99);
+    nth_element(samples.begin(), samples.begin() + k50, samples.end());
+    r.p50_us = samples[k50] / 1000.0;
+    nth_element(samples.begin(), samples.begin() + k99, samples.end());
+    r.p99_us = samples[k99] / 1000.0;
+    return r;
+}
+
+// طţⵥreceiveMedicineǼǡνʱprocessInOrder
+// ⵥdispenseMedicinecheckAndHandleWarningsԤˮдʱ־ļ
+int runWorkload(const WorkloadConfig& config) {
+    cout << " " << config.seed << "" << config.days << " 죬ƽմ "
+         << config.prescriptions_per_day << " /죬ҩƷ " << config.medicines << " " << endl;
+    auto gen_start = chrono::steady_clock::now();
+    Workload w = generateWorkload(config);
+    double gen_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - gen_start).count();
+    cout << "¼ " << w.events.size() << "  " << w.prescriptions << " ţⵥ "
+         << w.out_orders.size() << " ⵥ " << w.in_orders.size() << " ɺʱ "
+         << fixed << setprecision(1) << gen_ms << " msָ " << hex << w.checksum << dec << endl;
+
+    OrderedList *inventory = createOrderedList(config.medicines);
+    insertMedicines(inventory, w.catalogue.data(), config.medicines);
+    autoCheckWarnings(inventory);
+    CircularQueue *queue = createQueue(max(1024, config.medicines));
+    LinkedStack *stack = new LinkedStack();
+    remove(WORKLOAD_JOURNAL_FILE);
+    Journal *journal = openJournal(WORKLOAD_JOURNAL_FILE, 1, JOURNAL_BATCH_SIZE);
+    if (journal == nullptr) {
+        cout << "޷ʱˮ־ " << WORKLOAD_JOURNAL_FILE << endl;
+        delete stack;
+        destroyQueue(queue);
+        destroyOrderedList(inventory);
+        return -1;
+    }
+
+    vector<float> latency[3];
+    latency[WORKLOAD_OUT].reserve(w.out_orders.size());
+    latency[WORKLOAD_IN].reserve(w.in_orders.size());
+    int rejected = 0, failed = 0;
+
+    // processInOrder̨ӡطڼ
+    NullBuffer null_buffer;
+    streambuf *console = cout.rdbuf(&null_buffer);
+    auto start = chrono::steady_clock::now();
+    for (size_t k = 0; k < w.events.size(); k++) {
+        const WorkloadEvent& e = w.events[k];
+        auto t0 = chrono::steady_clock::now();
+        if (e.type == WORKLOAD_OUT) {
+            const OutOrderNode& out = w.out_orders[e.index];
+            int result = dispenseMedicine(inventory, stack, journal, out.med_id, out.quantity,
+                                          out.prescription_no, out.out_time);
+            if (result == 0) {
+                checkAndHandleWarnings(inventory, out.med_id);
+            } else if (result == -2) {
+                rejected++;
+            } else {
+                failed++;
             }
+        } else if (e.type == WORKLOAD_IN) {
+            const InOrder& in = w.in_orders[e.index];
+            bool queued = false;
+            if (receiveMedicine(inventory, queue, journal, in.med_id, in.quantity,
+                                in.operator_name, &queued, in.in_time) != 0 || !queued) {
+                failed++;
+            }
+        } else {
+            processInOrder(queue, inventory);
         }
-        
-        return count > 0 ? total_time / count : 0.0;
+        latency[e.type].push_back((float)chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count());
+    }
+    commitJournal(journal);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout.rdbuf(console);
+
+    // طŽӦȫһ
+    int mismatched = 0;
+    for (int i = 0; i < config.medicines; i++) {
+        Medicine *med = findMedicine(inventory, w.catalogue[i].id);
+        if (med == nullptr || med->stock != w.final_stock[i]) mismatched++;
+    }
+    int warning_count = countWarningMedicines(inventory);
+
+    cout << "طźʱ " << setprecision(3) << seconds << " s " << setprecision(0)
+         << w.events.size() / seconds << " ¼/" << endl;
+    static const char *NAMES[] = {"Ǽ", "⴦", "+Ԥ"};
+    cout << left << setw(14) << "¼" << right << setw(10) << ""
+         << setw(12) << "p50(us)" << setw(12) << "p99(us)" << endl;
+    for (int type = 0; type < 3; type++) {
+        WorkloadLatency s = summarizeLatency(latency[type]);
+        cout << left << setw(14) << NAMES[type] << right << setw(10) << s.count << setprecision(2)
+             << setw(12) << s.p50_us << setw(12) << s.p99_us << endl;
     }
+    cout << "治㱻ܣ" << rejected << "Ԥ " << w.stockouts << "ʧܣ" << failed
+         << "ĩ治" << mismatched << " ֣ǰԤ" << warning_count << " " << endl;
+    cout << "ֵڴ棺" << peakResidentKB() / 1024.0 << " MB" << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+
+    closeJournal(journal);
+    remove(WORKLOAD_JOURNAL_FILE);
+    delete stack;
+    destroyQueue(queue);
+    destroyOrderedList(inventory);
+    return (mismatched == 0 && failed == 0 && rejected == w.stockouts) ? 0 : -1;
+}
+
+void benchmarkMenu() {
+    system("cls");
+    cout << "==================== ܲ ====================" << endl;
+    cout << "1. Աȣ1/4/16ջնˣ" << endl;
+    cout << "2. Ԥںˣ1ǧ/10/100ҩƷ" << endl;
+    cout << "3. ⣨1~16̣߳" << endl;
+    cout << "4. ׼׼д" << BENCH_RESULT_FILE << "" << endl;
+    cout << "5. ϳطţ30죬ƽ400Ŵ1000ҩƷ" << endl;
+    cout << "0. ˵" << endl;
+    cout << "==================================================" << endl;
     
-    // ȽϽ
-    void compareThreeDaysUsage() const {
-        cout << "\n========== ҩԱ ==========" << endl;
-        
-        vector<MedicineUsage> usage_ranking = getUsageRanking(3);
-        vector<MedicineUsage> freq_ranking = getFrequencyRanking(3);
-        
-        cout << "\n1. ǰ5" << endl;
-        cout << left << setw(4) << "" 
-             << setw(10) << "ҩƷID" 
-             << setw(15) << "ҩƷ" 
-             << setw(10) << "" << endl;
-        cout << string(40, '-') << endl;
-        
-        for (size_t i = 0; i < min(usage_ranking.size(), size_t(5)); i++) {
-            cout << setw(4) << (i + 1)
-                 << setw(10) << usage_ranking[i].med_id
-                 << setw(15) << usage_ranking[i].med_name
-                 << setw(10) << usage_ranking[i].total_usage << endl;
+    int subChoice;
+    cout << "ѡ";
+    cin >> subChoice;
+    cin.ignore(); // 
+    
+    switch (subChoice) {
+        case 1: benchmarkInQueues(); break;
+        case 2: benchmarkWarningKernels(); break;
+        case 3: benchmarkConcurrentStocks(); break;
+        case 4: runBenchSuite(BENCH_RESULT_FILE, false); break;
+        case 5: {
+            WorkloadConfig config = {1, 30, 400, 1000};
+            runWorkload(config);
+            break;
         }
-        
-        cout << "\n2. ʹƵǰ5" << endl;
-        cout << left << setw(4) << "" 
-             << setw(10) << "ҩƷID" 
-             << setw(15) << "ҩƷ" 
-             << setw(12) << "ʹƵ" << endl;
-        cout << string(37, '-') << endl;
-        
-        for (size_t i = 0; i < min(freq_ranking.size(), size_t(5)); i++) {
-            cout << setw(4) << (i + 1)
-                 << setw(10) << freq_ranking[i].med_id
-                 << setw(15) << freq_ranking[i].med_name
-                 << setw(12) << freq_ranking[i].usage_frequency << endl;
+        case 0: break;
+        default: cout << "Ч" << endl;
+    }
+}
+
+// batch_mode.h - ޽ģʽӱ׼ļжȡִУÿһJSON
+// ֶԿհ׷ָ#ͷΪעͣ
+//   add <> <> <> <> <> <ֵ>    ҩƷ
+//   in <> <> [Ա]                        Ǽ
+//   out <> <> []                       Ǽǳ
+//   process                                          ⵥ
+//   stock <>                                     ѯ
+//   warnings                                         ǰԤҩƷ
+//   report []                                    ͳƣĬϵ죩
+//   save                                             ˮ
+//   quit                                             
+#define BATCH_MAX_FIELDS 8
+#define BATCH_LINE_LEN 512
+
+// JSONַţıԭд
+void printJsonString(const char *s) {
+    cout << '"';
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            cout << '\\' << (char)c;
+        } else if (c < 0x20) {
+            char buf[8];
+            sprintf(buf, "\\u%04x", c);
+            cout << buf;
+        } else {
+            cout << (char)c;
         }
-        
-        cout << "\n========================================" << endl;
     }
-    
-    // ÿձ
-    void generateDailyReport(const string& date) const {
-        cout << "\n==========================================" << endl;
-        cout << "          ҩճͳƱ" << endl;
-        cout << "ڣ" << date << endl;
-        cout << "==========================================" << endl;
-        
-        DailyStats stats = getDailyStats(date);
-        
-        cout << "\n1. ䷢ͳƣ" << endl;
-        cout << "   " << stats.prescription_count << endl;
-        cout << "   ܼ" << stats.total_dosage << endl;
-        
-        if (stats.prescription_count > 0) {
-            double avg_dosage = (double)stats.total_dosage / stats.prescription_count;
-            cout << "   ƽÿ" << fixed << setprecision(2) << avg_dosage << endl;
+    cout << '"';
+}
+
+void printBatchError(const char *cmd, int line_no, const char *error) {
+    cout << "{\"cmd\":";
+    printJsonString(cmd);
+    cout << ",\"ok\":false,\"line\":" << line_no << ",\"error\":\"" << error << "\"}\n";
+}
+
+// հԭзһУֶ
+int splitBatchLine(char *line, char **fields) {
+    int count = 0;
+    char *p = line;
+    while (count < BATCH_MAX_FIELDS) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0' || *p == '#') break;
+        fields[count++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        if (*p == '\0') break;
+        *p++ = '\0';
+    }
+    return count;
+}
+
+// ֶΣǷʱ-1
+int parseBatchInt(const char *s) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || v < 0 || v > INT_MAX) return -1;
+    return (int)v;
+}
+
+// ִһ0ɹ-1ʧܡ1ʾquit
+int runBatchCommand(char **f, int n, int line_no, OrderedList *inventory, CircularQueue *inQueue,
+                    LinkedStack *outStack, Journal *journal, Statistics& stats) {
+    const char *cmd = f[0];
+    
+    if (strcmp(cmd, "add") == 0) {
+        if (n != 7) { printBatchError(cmd, line_no, "bad_arguments"); return -1; }
+        Medicine med;
+        memset(&med, 0, sizeof(med));
+        med.id = parseBatchInt(f[1]);
+        med.stock = parseBatchInt(f[5]);
+        med.warning_threshold = parseBatchInt(f[6]);
+        if (med.id <= 0 || med.stock < 0 || med.warning_threshold < 0 ||
+            strlen(f[2]) >= MAX_NAME_LEN || strlen(f[3]) >= MAX_ORIGIN_LEN || strlen(f[4]) >= MAX_SPEC_LEN) {
+            printBatchError(cmd, line_no, "bad_arguments");
+            return -1;
+        }
+        if (findMedicine(inventory, med.id) != nullptr) {
+            printBatchError(cmd, line_no, "duplicate_id");
+            return -1;
+        }
+        strcpy(med.name, f[2]);
+        strcpy(med.origin, f[3]);
+        strcpy(med.spec, f[4]);
+        insertMedicine(inventory, med);
+        if (saveCatalogueChange(inventory, journal, outStack, "add") != 0) {
+            printBatchError(cmd, line_no, "save_failed");
+            return -1;
+        }
+        cout << "{\"cmd\":\"add\",\"ok\":true,\"id\":" << med.id << "}\n";
+        return 0;
+    }
+    
+    if (strcmp(cmd, "in") == 0 || strcmp(cmd, "out") == 0) {
+        bool is_in = cmd[0] == 'i';
+        int id = n >= 3 ? parseBatchInt(f[1]) : -1;
+        int quantity = n >= 3 ? parseBatchInt(f[2]) : -1;
+        if (n > 4 || id <= 0 || quantity <= 0) {
+            printBatchError(cmd, line_no, "bad_arguments");
+            return -1;
+        }
+        char ref[30];
+        if (n == 4) {
+            strncpy(ref, f[3], sizeof(ref) - 1);
+            ref[sizeof(ref) - 1] = '\0';
+        } else {
+            sprintf(ref, "batch-%d", line_no);
         }
         
-        cout << "\n2. ͳƣ" << endl;
-        cout << "   ⵥ" << stats.in_orders_count << endl;
-        cout << "   ⵥ" << stats.out_orders_count << endl;
-        
-        cout << "\n3. ԤӦͳƣ" << endl;
-        cout << "   ƽӦʱ䣺" << fixed << setprecision(2) << stats.avg_response_time << " Сʱ" << endl;
-        
-        // ʾҩƷ
-        cout << "\n4. ҩƷ" << endl;
-        vector<MedicineUsage> usage_list = getMedicineUsage(date);
-        
-        if (usage_list.empty()) {
-            cout << "   ޳¼" << endl;
+        int result;
+        bool queued = true;
+        if (is_in) {
+            ref[19] = '\0';     // Աֶֻ20ֽ
+            result = receiveMedicine(inventory, inQueue, journal, id, quantity, ref, &queued, 0);
         } else {
-            cout << left << setw(4) << "" 
-                 << setw(15) << "ҩƷ" 
-                 << setw(10) << "" 
-                 << setw(10) << "Ƶ" << endl;
-            cout << string(39, '-') << endl;
-            
-            for (size_t i = 0; i < min(usage_list.size(), size_t(5)); i++) {
-                cout << setw(4) << (i + 1)
-                     << setw(15) << usage_list[i].med_name
-                     << setw(10) << usage_list[i].total_usage
-                     << setw(10) << usage_list[i].usage_frequency << endl;
-            }
+            result = dispenseMedicine(inventory, outStack, journal, id, quantity, ref, 0);
         }
+        if (result == -1) { printBatchError(cmd, line_no, "not_found"); return -1; }
+        if (!is_in && result == -2) { printBatchError(cmd, line_no, "insufficient_stock"); return -1; }
+        if (is_in && result == -3) { printBatchError(cmd, line_no, "stock_overflow"); return -1; }
+        if (result != 0) { printBatchError(cmd, line_no, "journal_failed"); return -1; }
         
-        cout << "\n==========================================" << endl;
+        cout << "{\"cmd\":\"" << cmd << "\",\"ok\":true,\"id\":" << id
+             << ",\"quantity\":" << quantity
+             << ",\"stock\":" << findMedicine(inventory, id)->stock;
+        if (!queued) cout << ",\"queued\":false";
+        cout << "}\n";
+        return 0;
     }
     
-    // ɿ̨
-    void generateInReport(const string& date) const {
-        cout << "\n==========================================" << endl;
-        cout << "          ҩ浱̨" << endl;
-        cout << "ڣ" << date << endl;
-        cout << "==========================================" << endl;
-        
-        cout << left << setw(10) << "ҩƷID" 
-             << setw(15) << "ҩƷ" 
-             << setw(12) << "ǰս" 
-             << setw(12) << "" 
-             << setw(12) << "ճ" 
-             << setw(12) << "ս" << endl;
-        cout << string(73, '-') << endl;
-        
-        int total_daily_in = 0;
-        int total_daily_out = 0;
-        
-        for (int i = 0; i < inventory->length; i++) {
-            Medicine med = inventory->medicines[i];
-            
-            // 㵱
-            int daily_in = 0;
-            for (int j = 0; j < in_queue->size; j++) {
-                int index = (in_queue->front + j) % in_queue->capacity;
-                if (in_queue->orders[index].med_id == med.id && 
-                    string(in_queue->orders[index].date) == date) {
-                    daily_in += in_queue->orders[index].quantity;
-                }
-            }
-            
-            // 㵱ճ
-            int daily_out = out_stack->getMedicineOutTotal(med.id, date);
-            
-            // ǰսࣨǰ -  + ճ⣩
-            int prev_balance = med.stock - daily_in + daily_out;
-            int current_balance = med.stock;
-            
-            cout << setw(10) << med.id
-                 << setw(15) << med.name
-                 << setw(12) << prev_balance
-                 << setw(12) << daily_in
-                 << setw(12) << daily_out
-                 << setw(12) << current_balance << endl;
-                 
-            total_daily_in += daily_in;
-            total_daily_out += daily_out;
+    if (strcmp(cmd, "process") == 0) {
+        vector<InOrder> orders;
+        int count = takeAllInOrders(inQueue, orders);
+        InBatchSummary summary = applyInOrderBatch(inventory, orders.data(), count, false);
+        autoCheckWarnings(inventory);
+        cout << "{\"cmd\":\"process\",\"ok\":true,\"orders\":" << count - summary.unknown
+             << ",\"medicines\":" << summary.medicines
+             << ",\"quantity\":" << summary.quantity
+             << ",\"unknown\":" << summary.unknown << "}\n";
+        return 0;
+    }
+    
+    if (strcmp(cmd, "stock") == 0) {
+        Medicine *med = n == 2 ? findMedicine(inventory, parseBatchInt(f[1])) : nullptr;
+        if (med == nullptr) {
+            printBatchError(cmd, line_no, n == 2 ? "not_found" : "bad_arguments");
+            return -1;
         }
-        
-        cout << string(73, '-') << endl;
-        cout << left << setw(10) << "ϼ"
-             << setw(15) << ""
-             << setw(12) << ""
-             << setw(12) << total_daily_in
-             << setw(12) << total_daily_out
-             << setw(12) << "" << endl;
-        cout << "==========================================" << endl;
+        autoCheckWarnings(inventory);
+        cout << "{\"cmd\":\"stock\",\"ok\":true,\"id\":" << med->id << ",\"name\":";
+        printJsonString(med->name);
+        cout << ",\"stock\":" << med->stock
+             << ",\"threshold\":" << med->warning_threshold
+             << ",\"warning\":" << (med->is_warning ? "true" : "false") << "}\n";
+        return 0;
     }
-};
-
-// medicine_management.h - ҩƷ
-int validateMedicineID(OrderedList *list, int id) {
-    if (id <= 0) {
-        cout << "ҩƷIDΪ" << endl;
-        return -1;
+    
+    if (strcmp(cmd, "warnings") == 0) {
+        vector<Medicine*> meds = getWarningMedicines(inventory);
+        cout << "{\"cmd\":\"warnings\",\"ok\":true,\"count\":" << meds.size() << ",\"items\":[";
+        for (size_t i = 0; i < meds.size(); i++) {
+            cout << (i > 0 ? "," : "") << "{\"id\":" << meds[i]->id << ",\"name\":";
+            printJsonString(meds[i]->name);
+            cout << ",\"stock\":" << meds[i]->stock
+                 << ",\"threshold\":" << meds[i]->warning_threshold << "}";
+        }
+        cout << "]}\n";
+        return 0;
     }
-    if (findMedicine(list, id) != nullptr) {
-        cout << "ҩƷID=" << id << "Ѵڣظӣ" << endl;
-        return -2;
+    
+    if (strcmp(cmd, "report") == 0) {
+        char today[11];
+        time_t now = time(nullptr);
+        strftime(today, sizeof(today), "%Y-%m-%d", localtime(&now));
+        const char *date = n >= 2 ? f[1] : today;
+        if (n > 2 || dateToDayNumber(date) < 0) {
+            printBatchError(cmd, line_no, "bad_arguments");
+            return -1;
+        }
+        autoCheckWarnings(inventory);
+        Statistics::DailyStats daily = stats.getDailyStats(date);
+        cout << "{\"cmd\":\"report\",\"ok\":true,\"date\":";
+        printJsonString(date);
+        cout << ",\"prescriptions\":" << daily.prescription_count
+             << ",\"dosage\":" << daily.total_dosage
+             << ",\"in_orders\":" << daily.in_orders_count
+             << ",\"out_orders\":" << daily.out_orders_count
+             << ",\"avg_response_hours\":" << fixed << setprecision(2) << daily.avg_response_time
+             << ",\"medicines\":" << inventory->length
+             << ",\"total_stock\":" << getTotalStock(inventory)
+             << ",\"warnings\":" << countWarningMedicines(inventory) << "}\n";
+        return 0;
     }
-    return 0; // ֤ͨ
+    
+    if (strcmp(cmd, "save") == 0) {
+        if (checkpointCatalogue(inventory, journal, outStack) != 0) {
+            printBatchError(cmd, line_no, "save_failed");
+            return -1;
+        }
+        cout << "{\"cmd\":\"save\",\"ok\":true,\"medicines\":" << inventory->length << "}\n";
+        return 0;
+    }
+    
+    if (strcmp(cmd, "quit") == 0) return 1;
+    
+    printBatchError(cmd, line_no, "unknown_command");
+    return -1;
 }
 
-int validateMedicineInfo(Medicine *med) {
-    if (strlen(med->name) == 0 || strlen(med->name) >= MAX_NAME_LEN) {
-        cout << "ҩƷƲΪҳȲܳ" << MAX_NAME_LEN-1 << "ַ" << endl;
-        return -1;
+// ѭfilenameΪnullptr"-"ʱ׼롣ʱˮ棬
+// һлܡʧܵ
+int runBatchMode(const char *filename, OrderedList *inventory, CircularQueue *inQueue,
+                 LinkedStack *outStack, Journal *journal) {
+    FILE *in = stdin;
+    if (filename != nullptr && strcmp(filename, "-") != 0) {
+        in = fopen(filename, "r");
+        if (in == nullptr) {
+            printBatchError("open", 0, "cannot_open_file");
+            return 1;
+        }
     }
-    if (strlen(med->origin) == 0 || strlen(med->origin) >= MAX_ORIGIN_LEN) {
-        cout << "󣺲زΪҳȲܳ" << MAX_ORIGIN_LEN-1 << "ַ" << endl;
-        return -2;
+    
+    ios::sync_with_stdio(false);    // н϶࣬printfͬ
+    Statistics stats(inventory, inQueue, outStack);
+    char line[BATCH_LINE_LEN];
+    char *fields[BATCH_MAX_FIELDS];
+    int line_no = 0, commands = 0, failed = 0;
+    
+    auto start = chrono::steady_clock::now();
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        line_no++;
+        int n = splitBatchLine(line, fields);
+        if (n == 0) continue;
+        
+        refreshCurrentDay();
+        int result = runBatchCommand(fields, n, line_no, inventory, inQueue, outStack, journal, stats);
+        if (result == 1) break;
+        commands++;
+        if (result != 0) failed++;
     }
-    if (strlen(med->spec) == 0 || strlen(med->spec) >= MAX_SPEC_LEN) {
-        cout << "󣺹ΪҳȲܳ" << MAX_SPEC_LEN-1 << "ַ" << endl;
-        return -3;
+    if (in != stdin) fclose(in);
+    
+    autoCheckWarnings(inventory);
+    bool saved = checkpointCatalogue(inventory, journal, outStack) == 0;
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << "{\"summary\":true,\"commands\":" << commands << ",\"failed\":" << failed
+         << ",\"saved\":" << (saved ? "true" : "false")
+         << ",\"seconds\":" << fixed << setprecision(3) << seconds
+         << ",\"commands_per_sec\":" << setprecision(0) << (seconds > 0 ? commands / seconds : 0.0)
+         << "}" << endl;
+    logEvent(LOG_INFO, "batch", "commands=%d failed=%d seconds=%.3f", commands, failed, seconds);
+    return failed;
+}
+
+// http_server.h - HTTP/JSONӿڣsystem.htmlã
+// ߳¼ѭLinuxepollƽ̨selectֻ127.0.0.1֧HTTP/1.1ӡ
+// ֱӶջİջܣˢҳ治ɨⵥݡòѯurlencoded
+#define HTTP_DEFAULT_PORT 8080
+#define HTTP_MAX_CONNECTIONS 256
+#define HTTP_MAX_HEADER 16384       // ͷ
+#define HTTP_MAX_BODY 65536         // 
+#define HTTP_PAGE_FILE "system.html"
+
+#ifdef _WIN32
+typedef SOCKET socket_t;
+const socket_t BAD_SOCKET = INVALID_SOCKET;
+void closeSocket(socket_t s) { closesocket(s); }
+bool setNonBlocking(socket_t s) {
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+}
+bool socketWouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+typedef int socket_t;
+const socket_t BAD_SOCKET = -1;
+void closeSocket(socket_t s) { close(s); }
+bool setNonBlocking(socket_t s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+bool socketWouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+#endif
+
+struct PollEvent {
+    socket_t fd;
+    bool readable;
+    bool writable;
+};
+
+// ֪ͨĿɶдʱٹĿд
+class EventPoller {
+private:
+#ifdef __linux__
+    int epfd;
+    vector<epoll_event> ready;
+#else
+    map<socket_t, bool> watched;    // ׽ -> ǷĿд
+#endif
+
+public:
+#ifdef __linux__
+    EventPoller() : epfd(-1), ready(64) {}
+    bool open() { return (epfd = epoll_create1(0)) >= 0; }
+    ~EventPoller() { if (epfd >= 0) ::close(epfd); }
+
+    void watch(socket_t fd, bool want_write, int op) {
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | (want_write ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        epoll_ctl(epfd, op, fd, &ev);
     }
-    if (med->stock < 0) {
-        cout << "󣺿Ϊ" << endl;
-        return -4;
+    void add(socket_t fd) { watch(fd, false, EPOLL_CTL_ADD); }
+    void setWantWrite(socket_t fd, bool want_write) { watch(fd, want_write, EPOLL_CTL_MOD); }
+    void remove(socket_t fd) { epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr); }
+
+    int wait(vector<PollEvent>& events, int timeout_ms) {
+        events.clear();
+        int n = epoll_wait(epfd, ready.data(), (int)ready.size(), timeout_ms);
+        for (int i = 0; i < n; i++) {
+            unsigned int e = ready[i].events;
+            PollEvent pe = {ready[i].data.fd, (e & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0, (e & EPOLLOUT) != 0};
+            events.push_back(pe);
+        }
+        return n;
     }
-    if (med->warning_threshold < 0) {
-        cout << "ԤֵΪ" << endl;
-        return -5;
+#else
+    bool open() { return true; }
+    void add(socket_t fd) { watched[fd] = false; }
+    void setWantWrite(socket_t fd, bool want_write) { watched[fd] = want_write; }
+    void remove(socket_t fd) { watched.erase(fd); }
+
+    int wait(vector<PollEvent>& events, int timeout_ms) {
+        events.clear();
+        fd_set rset, wset;
+        FD_ZERO(&rset);
+        FD_ZERO(&wset);
+        socket_t max_fd = 0;
+        for (auto& w : watched) {
+            FD_SET(w.first, &rset);
+            if (w.second) FD_SET(w.first, &wset);
+            max_fd = max(max_fd, w.first);
+        }
+        timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        int n = select((int)max_fd + 1, &rset, &wset, nullptr, &tv);
+        if (n <= 0) return n;
+        for (auto& w : watched) {
+            PollEvent pe = {w.first, FD_ISSET(w.first, &rset) != 0, FD_ISSET(w.first, &wset) != 0};
+            if (pe.readable || pe.writable) events.push_back(pe);
+        }
+        return (int)events.size();
     }
-    return 0; // ֤ͨ
-}
+#endif
+};
 
-// ȫȡַ
-void safeReadString(char* buffer, int maxSize) {
-    cin.getline(buffer, maxSize);
-    // Ƴз
-    int len = strlen(buffer);
-    if (len > 0 && buffer[len-1] == '\n') {
-        buffer[len-1] = '\0';
+// ׷JSONַGBKתUTF-8ת壩
+void appendJsonString(string& out, const char *gbk) {
+    string text;
+    convertText(true, gbk, strlen(gbk), text);
+    out += '"';
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char buf[8];
+            sprintf(buf, "\\u%04x", c);
+            out += buf;
+        } else {
+            out += (char)c;
+        }
     }
+    out += '"';
 }
 
-int addMedicine(OrderedList *list) {
-    if (list == nullptr || list->length >= list->capacity) {
-        cout << "󣺿޷ҩƷ" << endl;
-        return -1;
-    }
+void appendJsonField(string& out, const char *key, long long value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    out += to_string(value);
+}
 
-    Medicine med = {0};
-    cout << "\n===== ҩƷ =====" << endl;
+//  a=1&b=%E7%94%98 ʽĲֵתΪGBK
+void parseUrlParams(const string& s, map<string, string>& params) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t amp = s.find('&', pos);
+        if (amp == string::npos) amp = s.size();
+        string pair = s.substr(pos, amp - pos);
+        pos = amp + 1;
+        size_t eq = pair.find('=');
+        string key = pair.substr(0, eq);
+        string raw = eq == string::npos ? "" : pair.substr(eq + 1);
 
-    while (true) {
-        cout << "ҩƷID";
-        cin >> med.id;
-        cin.ignore(); // еĻз
-        if (validateMedicineID(list, med.id) == 0) {
-            break;
+        string value;
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] == '+') {
+                value += ' ';
+            } else if (raw[i] == '%' && i + 2 < raw.size() && isxdigit((unsigned char)raw[i + 1]) &&
+                       isxdigit((unsigned char)raw[i + 2])) {
+                value += (char)strtol(raw.substr(i + 1, 2).c_str(), nullptr, 16);
+                i += 2;
+            } else {
+                value += raw[i];
+            }
         }
-        cout << "룡" << endl;
+        convertText(false, value.data(), value.size(), params[key]);
     }
+}
 
-    cout << "ҩƷƣ";
-    safeReadString(med.name, MAX_NAME_LEN);
-    cout << "ҩƷأ";
-    safeReadString(med.origin, MAX_ORIGIN_LEN);
-    cout << "ҩƷ";
-    safeReadString(med.spec, MAX_SPEC_LEN);
-    cout << "ʼg";
-    cin >> med.stock;
-    cin.ignore(); // 
-    cout << "ʼԤֵg";
-    cin >> med.warning_threshold;
-    cin.ignore(); // 
+struct HttpRequest {
+    string method;
+    string path;
+    map<string, string> params;     // ѯ
+    bool keep_alive;
+    string host;                    // HostͷСд
+    string origin;                  // OriginͷСдûʱΪգ
+    bool requested_with;            // X-Requested-Withͷ
+};
 
-    med.last_usage = 0;
-    memset(med.usage_history, 0, sizeof(med.usage_history));
-    med.is_warning = 0;
-    med.warning_time = 0;
-    med.response_time = 0;
+struct HttpResponse {
+    int status;
+    const char *content_type;
+    string body;
+};
 
-    if (validateMedicineInfo(&med) != 0) {
-        cout << "ʧܣҩƷϢϷ" << endl;
-        return -2;
-    }
+struct HttpConnection {
+    string in;                  // յδֽ
+    string out;                 // ͵ֽ
+    size_t out_pos;
+    bool close_after;           // ر
+    bool held;                  // Ӧ޸Ŀ󣬵ȱˮ̺ŷ
+    HttpConnection() : out_pos(0), close_after(false), held(false) {}
+};
 
-    if (insertMedicine(list, med) == 0) {
-        cout << "ɹҩƷƣ" << med.name << "ID:" << med.id << "" << endl;
-        return 0;
-    } else {
-        cout << "ʧܣδ֪" << endl;
-        return -3;
+const char* httpStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        default: return "Unknown";
     }
 }
 
-int modifyMedicine(OrderedList *list) {
-    if (list == nullptr || list->length == 0) {
-        cout << "󣺿ΪգҩƷ޸ģ" << endl;
-        return -1;
-    }
+volatile sig_atomic_t g_http_stop = 0;
 
-    int id;
-    cout << "\n===== ޸ҩƷ =====" << endl;
-    cout << "Ҫ޸ĵҩƷID";
-    cin >> id;
-    cin.ignore(); // 
+void onHttpStopSignal(int) {
+    g_http_stop = 1;
+}
 
-    Medicine *med = findMedicine(list, id);
-    if (med == nullptr) {
-        cout << "δҵID=" << id << "ҩƷ" << endl;
-        return -2;
+class HttpServer {
+private:
+    OrderedList *inventory;
+    CircularQueue *inQueue;
+    LinkedStack *outStack;
+    Journal *journal;
+    Statistics stats;
+    socket_t listener;
+    EventPoller poller;
+    map<socket_t, HttpConnection> connections;
+    string page;                // system.html
+    bool changed;               // ¼пб䶯
+    vector<socket_t> held;      // ȴˮ̺ٷӦ
+    int port;                   // ˿
+    
+    // HostǱַӼ˿ڣֹDNSذ󶨺ⲿҳȡ
+    bool allowedHost(const string& host) const {
+        string suffix = ":" + to_string(port);
+        if (host == "127.0.0.1" + suffix || host == "localhost" + suffix) return true;
+        return port == 80 && (host == "127.0.0.1" || host == "localhost");
+    }
+    
+    // ޸ݵ󣺴OriginʱͬԴX-Requested-Withͷ
+    // վҳԶͷҪȷԤ죬ӦԤ죬˲ᷢ
+    bool allowedWrite(const HttpRequest& req) const {
+        if (!req.requested_with) return false;
+        if (req.origin.empty()) return true;
+        return req.origin.compare(0, 7, "http://") == 0 && allowedHost(req.origin.substr(7));
     }
 
-    cout << "\nǰҩƷϢ" << endl;
-    cout << "ID" << med->id << "޸ģ" << endl;
-    cout << "ƣ" << med->name << endl;
-    cout << "أ" << med->origin << endl;
-    cout << "" << med->spec << endl;
-    cout << "" << med->stock << "g" << endl;
-    cout << "Ԥֵ" << med->warning_threshold << "g" << endl;
+    static void jsonError(HttpResponse& res, int status, const char *error) {
+        res.status = status;
+        res.body = string("{\"ok\":false,\"error\":\"") + error + "\"}";
+    }
 
-    cout << "\nϢֱӻسԭϢ" << endl;
+    static int intParam(const HttpRequest& req, const char *key) {
+        auto it = req.params.find(key);
+        if (it == req.params.end() || it->second.empty()) return -1;
+        char *end;
+        long v = strtol(it->second.c_str(), &end, 10);
+        return (*end != '\0' || v < 0 || v > INT_MAX) ? -1 : (int)v;
+    }
 
-    char input[MAX_NAME_LEN];
-    cout << "ƣԭ" << med->name << "";
-    safeReadString(input, MAX_NAME_LEN);
-    if (strlen(input) > 0) {
-        strncpy(med->name, input, MAX_NAME_LEN-1);
-        med->name[MAX_NAME_LEN-1] = '\0';
+    static string textParam(const HttpRequest& req, const char *key) {
+        auto it = req.params.find(key);
+        return it == req.params.end() ? "" : it->second;
     }
 
-    cout << "أԭ" << med->origin << "";
-    safeReadString(input, MAX_ORIGIN_LEN);
-    if (strlen(input) > 0) {
-        strncpy(med->origin, input, MAX_ORIGIN_LEN-1);
-        med->origin[MAX_ORIGIN_LEN-1] = '\0';
+    string todayString() const {
+        char today[11];
+        time_t now = time(nullptr);
+        strftime(today, sizeof(today), "%Y-%m-%d", localtime(&now));
+        return today;
     }
 
-    cout << "ԭ" << med->spec << "";
-    safeReadString(input, MAX_SPEC_LEN);
-    if (strlen(input) > 0) {
-        strncpy(med->spec, input, MAX_SPEC_LEN-1);
-        med->spec[MAX_SPEC_LEN-1] = '\0';
+    void appendMedicine(string& out, const Medicine *med) {
+        out += '{';
+        appendJsonField(out, "id", med->id);
+        out += ",\"name\":";
+        appendJsonString(out, med->name);
+        out += ",\"origin\":";
+        appendJsonString(out, med->origin);
+        out += ",\"spec\":";
+        appendJsonString(out, med->spec);
+        out += ',';
+        appendJsonField(out, "stock", med->stock);
+        out += ',';
+        appendJsonField(out, "warning_threshold", med->warning_threshold);
+        out += ",\"is_warning\":";
+        out += med->is_warning ? "true" : "false";
+        out += ',';
+        appendJsonField(out, "last_usage", med->last_usage);
+        out += ',';
+        appendJsonField(out, "three_day_avg", calculateThreeDayAverage(const_cast<Medicine*>(med)));
+        out += ",\"usage_history\":[";  // 7һΪ
+        for (int k = HISTORY_DAYS - 1; k >= 0; k--) {
+            out += to_string(getDayUsage(med, k));
+            if (k > 0) out += ',';
+        }
+        out += "]}";
     }
 
-    cout << "ԭ" << med->stock << "g";
-    safeReadString(input, 20);
-    if (strlen(input) > 0) {
-        int new_stock = atoi(input);
-        if (new_stock >= 0) {
-            med->stock = new_stock;
+    void appendUsageList(string& out, const vector<MedicineUsage>& list) {
+        out += '[';
+        for (size_t i = 0; i < list.size(); i++) {
+            if (i > 0) out += ',';
+            out += '{';
+            appendJsonField(out, "id", list[i].med_id);
+            out += ",\"name\":";
+            appendJsonString(out, list[i].med_name.c_str());
+            out += ',';
+            appendJsonField(out, "quantity", list[i].total_usage);
+            out += ',';
+            appendJsonField(out, "count", list[i].usage_frequency);
+            out += '}';
+        }
+        out += ']';
+    }
+
+    // ҩƷɾģPOST /api/medicinesPUT|DELETE /api/medicines/{id}
+    void handleMedicineWrite(const HttpRequest& req, int path_id, HttpResponse& res) {
+        if (req.method == "DELETE") {
+            if (deleteMedicine(inventory, path_id) != 0) return jsonError(res, 404, "not_found");
+            if (saveCatalogueChange(inventory, journal, outStack, "delete") != 0) {
+                return jsonError(res, 500, "save_failed");
+            }
+            changed = true;
+            res.body = "{\"ok\":true}";
+            return;
+        }
+
+        Medicine med;
+        memset(&med, 0, sizeof(med));
+        med.id = req.method == "PUT" ? path_id : intParam(req, "id");
+        med.stock = intParam(req, "stock");
+        med.warning_threshold = intParam(req, "warning_threshold");
+        string name = textParam(req, "name");
+        string origin = textParam(req, "origin");
+        string spec = textParam(req, "spec");
+        if (med.id <= 0 || med.stock < 0 || med.warning_threshold < 0 ||
+            name.empty() || name.size() >= MAX_NAME_LEN || origin.size() >= MAX_ORIGIN_LEN ||
+            spec.size() >= MAX_SPEC_LEN) {
+            return jsonError(res, 400, "bad_arguments");
+        }
+        strcpy(med.name, name.c_str());
+        strcpy(med.origin, origin.c_str());
+        strcpy(med.spec, spec.c_str());
+
+        Medicine *old = findMedicine(inventory, med.id);
+        if (req.method == "POST") {
+            if (old != nullptr) return jsonError(res, 409, "duplicate_id");
+            insertMedicine(inventory, med);
         } else {
-            cout << "棺Ϊԭֵ" << endl;
+            if (old == nullptr) return jsonError(res, 404, "not_found");
+            // ֻĻϢֵ䶯߳⣬ˮ
+            if (med.stock != old->stock) return jsonError(res, 409, "stock_changes_use_in_out");
+            med.last_usage = old->last_usage;
+            med.usage_history = old->usage_history;
+            med.is_warning = old->is_warning;
+            med.warning_time = old->warning_time;
+            med.response_time = old->response_time;
+            updateMedicine(inventory, med);
+        }
+        if (saveCatalogueChange(inventory, journal, outStack, req.method == "POST" ? "add" : "update") != 0) {
+            return jsonError(res, 500, "save_failed");
         }
+        changed = true;
+        autoCheckWarnings(inventory);
+        res.body = "{\"ok\":true,\"medicine\":";
+        appendMedicine(res.body, findMedicine(inventory, med.id));
+        res.body += '}';
     }
 
-    cout << "Ԥֵԭ" << med->warning_threshold << "g";
-    safeReadString(input, 20);
-    if (strlen(input) > 0) {
-        int new_threshold = atoi(input);
-        if (new_threshold >= 0) {
-            med->warning_threshold = new_threshold;
+    void handleInOut(const HttpRequest& req, bool is_in, HttpResponse& res) {
+        int id = intParam(req, "med_id");
+        int quantity = intParam(req, "quantity");
+        if (id <= 0 || quantity <= 0) return jsonError(res, 400, "bad_arguments");
+
+        int result;
+        bool queued = true;
+        if (is_in) {
+            string op = textParam(req, "operator_name");
+            char name[20];
+            strncpy(name, op.empty() ? "web" : op.c_str(), sizeof(name) - 1);
+            name[sizeof(name) - 1] = '\0';
+            result = receiveMedicine(inventory, inQueue, journal, id, quantity, name, &queued, 0);
         } else {
-            cout << "棺ԤֵΪԭֵ" << endl;
+            string rx = textParam(req, "prescription_no");
+            char no[30];
+            strncpy(no, rx.empty() ? "web" : rx.c_str(), sizeof(no) - 1);
+            no[sizeof(no) - 1] = '\0';
+            result = dispenseMedicine(inventory, outStack, journal, id, quantity, no, 0);
         }
-    }
+        if (result == -1) return jsonError(res, 404, "not_found");
+        if (!is_in && result == -2) return jsonError(res, 409, "insufficient_stock");
+        if (is_in && result == -3) return jsonError(res, 409, "stock_overflow");
+        if (result != 0) return jsonError(res, 500, "journal_failed");
 
-    if (validateMedicineInfo(med) != 0) {
-        cout << "޸ʧܣϢϷԶԭϷֵ" << endl;
-        return -3;
+        changed = true;
+        autoCheckWarnings(inventory);
+        res.body = "{\"ok\":true,";
+        res.body += queued ? "" : "\"queued\":false,";
+        res.body += "\"medicine\":";
+        appendMedicine(res.body, findMedicine(inventory, id));
+        res.body += '}';
     }
 
-    cout << "޸ĳɹ" << endl;
-    return 0;
-}
+    // ձǰ5Գջİջ
+    void handleDailyReport(const HttpRequest& req, HttpResponse& res) {
+        string date = textParam(req, "date");
+        if (date.empty()) date = todayString();
+        DayId day = dateToDayNumber(date.c_str());
+        if (day < 0) return jsonError(res, 400, "bad_arguments");
 
-int removeMedicine(OrderedList *list) {
-    if (list == nullptr || list->length == 0) {
-        cout << "󣺿ΪգҩƷɾ" << endl;
-        return -1;
+        Statistics::DailyStats daily = stats.getDailyStats(date);
+        res.body = "{\"ok\":true,\"date\":";
+        appendJsonString(res.body, date.c_str());
+        res.body += ',';
+        appendJsonField(res.body, "prescriptions", daily.prescription_count);
+        res.body += ',';
+        appendJsonField(res.body, "dosage", daily.total_dosage);
+        res.body += ',';
+        appendJsonField(res.body, "in_orders", daily.in_orders_count);
+        res.body += ',';
+        appendJsonField(res.body, "out_orders", daily.out_orders_count);
+        res.body += ",\"avg_response_hours\":";
+        char buf[32];
+        sprintf(buf, "%.2f", daily.avg_response_time);
+        res.body += buf;
+        res.body += ",\"top\":";
+        appendUsageList(res.body, stats.aggregateUsage(day, day, 5, false));
+        res.body += '}';
     }
 
-    int id;
-    cout << "\n===== ɾҩƷ =====" << endl;
-    cout << "ҪɾҩƷID";
-    cin >> id;
-    cin.ignore(); // 
+    // ̨ˣճ֮յľ䶯ȡ԰ͳͼⵥӡⵥջڣ
+    // ӵǰ浹Ƶս
+    void handleLedger(const HttpRequest& req, HttpResponse& res) {
+        string date = textParam(req, "date");
+        if (date.empty()) date = todayString();
+        DayId day = dateToDayNumber(date.c_str());
+        if (day < 0) return jsonError(res, 400, "bad_arguments");
 
-    Medicine *med = findMedicine(list, id);
-    if (med == nullptr) {
-        cout << "δҵID=" << id << "ҩƷ" << endl;
-        return -2;
-    }
+        unordered_map<int, MedLedger> ledger = getDailyLedger(inventory->daily, day);
 
-    cout << "ȷҪɾҩƷ" << med->name << "ID:" << id << "𣿣Y/N";
-    char confirm = _getch();
-    cout << endl;
+        long long total_in = 0, total_out = 0;
+        res.body = "{\"ok\":true,\"date\":";
+        appendJsonString(res.body, date.c_str());
+        res.body += ",\"rows\":[";
+        for (int i = 0; i < inventory->length; i++) {
+            const Medicine *med = &inventory->medicines[i];
+            auto it = ledger.find(med->id);
+            MedLedger entry = it == ledger.end() ? MedLedger() : it->second;
+            long long in_qty = entry.in_quantity;
+            long long out_qty = entry.out_quantity;
+            long long balance = med->stock - entry.later_net;
+            total_in += in_qty;
+            total_out += out_qty;
 
-    if (confirm == 'Y' || confirm == 'y') {
-        if (deleteMedicine(list, id) == 0) {
-            cout << "ɾɹ" << endl;
-            return 0;
-        } else {
-            cout << "ɾʧܣδ֪" << endl;
-            return -3;
+            if (i > 0) res.body += ',';
+            res.body += '{';
+            appendJsonField(res.body, "id", med->id);
+            res.body += ",\"name\":";
+            appendJsonString(res.body, med->name);
+            res.body += ',';
+            appendJsonField(res.body, "prev_balance", balance - in_qty + out_qty);
+            res.body += ',';
+            appendJsonField(res.body, "in", in_qty);
+            res.body += ',';
+            appendJsonField(res.body, "out", out_qty);
+            res.body += ',';
+            appendJsonField(res.body, "stock", balance);
+            res.body += '}';
         }
-    } else {
-        cout << "ȡɾ" << endl;
-        return -4;
+        res.body += "],";
+        appendJsonField(res.body, "total_in", total_in);
+        res.body += ',';
+        appendJsonField(res.body, "total_out", total_out);
+        res.body += '}';
     }
-}
 
-void queryMedicine(OrderedList *list) {
-    if (list == nullptr || list->length == 0) {
-        cout << "󣺿ΪգҩƷɲѯ" << endl;
-        return;
+    void route(const HttpRequest& req, HttpResponse& res) {
+        res.status = 200;
+        res.content_type = "application/json; charset=utf-8";
+        const string& path = req.path;
+        bool get = req.method == "GET";
+        
+        if (!allowedHost(req.host)) return jsonError(res, 403, "forbidden_host");
+        if (!get && !allowedWrite(req)) return jsonError(res, 403, "forbidden_origin");
+
+        if (get && (path == "/" || path == "/" HTTP_PAGE_FILE)) {
+            if (page.empty()) return jsonError(res, 404, "page_not_found");
+            res.content_type = "text/html; charset=utf-8";
+            res.body = page;
+            return;
+        }
+
+        const string prefix = "/api/medicines";
+        if (path == prefix) {
+            if (req.method == "POST") return handleMedicineWrite(req, 0, res);
+            if (!get) return jsonError(res, 405, "method_not_allowed");
+            res.body = "{\"ok\":true,";
+            appendJsonField(res.body, "total_stock", getTotalStock(inventory));
+            res.body += ",\"medicines\":[";
+            for (int i = 0; i < inventory->length; i++) {
+                if (i > 0) res.body += ',';
+                appendMedicine(res.body, &inventory->medicines[i]);
+            }
+            res.body += "]}";
+            return;
+        }
+        if (path.compare(0, prefix.size() + 1, prefix + "/") == 0) {
+            char *end;
+            long id = strtol(path.c_str() + prefix.size() + 1, &end, 10);
+            if (*end != '\0' || id <= 0 || id > INT_MAX) return jsonError(res, 404, "not_found");
+            if (req.method == "PUT" || req.method == "DELETE") return handleMedicineWrite(req, (int)id, res);
+            if (!get) return jsonError(res, 405, "method_not_allowed");
+            Medicine *med = findMedicine(inventory, (int)id);
+            if (med == nullptr) return jsonError(res, 404, "not_found");
+            res.body = "{\"ok\":true,\"medicine\":";
+            appendMedicine(res.body, med);
+            res.body += '}';
+            return;
+        }
+
+        if (path == "/api/in" && req.method == "POST") return handleInOut(req, true, res);
+        if (path == "/api/out" && req.method == "POST") return handleInOut(req, false, res);
+        if (path == "/api/in/process" && req.method == "POST") {
+            vector<InOrder> orders;
+            int n = takeAllInOrders(inQueue, orders);
+            InBatchSummary summary = applyInOrderBatch(inventory, orders.data(), n, false);
+            autoCheckWarnings(inventory);
+            res.body = "{\"ok\":true,";
+            appendJsonField(res.body, "orders", n - summary.unknown);
+            res.body += ',';
+            appendJsonField(res.body, "medicines", summary.medicines);
+            res.body += ',';
+            appendJsonField(res.body, "quantity", summary.quantity);
+            res.body += '}';
+            return;
+        }
+
+        if (path == "/api/warnings" && get) {
+            vector<Medicine*> meds = getWarningMedicines(inventory);
+            res.body = "{\"ok\":true,\"medicines\":[";
+            for (size_t i = 0; i < meds.size(); i++) {
+                if (i > 0) res.body += ',';
+                appendMedicine(res.body, meds[i]);
+            }
+            res.body += "]}";
+            return;
+        }
+        if (path == "/api/thresholds/refresh" && req.method == "POST") {
+            int n = refreshAllThresholds(inventory);
+            autoCheckWarnings(inventory);
+            changed = true;
+            res.body = "{\"ok\":true,";
+            appendJsonField(res.body, "changed", n);
+            res.body += '}';
+            return;
+        }
+
+        if (path == "/api/reports/daily" && get) return handleDailyReport(req, res);
+        if (path == "/api/reports/ranking" && get) {
+            int days = intParam(req, "days");
+            int top = intParam(req, "top");
+            bool by_frequency = textParam(req, "by") == "frequency";
+            if (days <= 0) days = 3;
+            if (top <= 0) top = 5;
+            res.body = "{\"ok\":true,";
+            appendJsonField(res.body, "days", days);
+            res.body += ",\"ranking\":";
+            appendUsageList(res.body, by_frequency ? stats.getFrequencyRanking(days, top)
+                                                   : stats.getUsageRanking(days, top));
+            res.body += '}';
+            return;
+        }
+        if (path == "/api/ledger" && get) return handleLedger(req, res);
+
+        jsonError(res, 404, "not_found");
     }
 
-    int choice;
-    cout << "\n===== ѯҩƷ =====" << endl;
-    cout << "1. IDȷѯ" << endl;
-    cout << "2. ģѯ" << endl;
-    cout << "ѡѯʽ";
-    cin >> choice;
-    cin.ignore(); // 
+    // 󣬷ĵֽ0ʽ󷵻-1
+    long parseRequest(const string& buf, HttpRequest& req, int& error_status) {
+        size_t header_end = buf.find("\r\n\r\n");
+        if (header_end == string::npos) {
+            error_status = 413;
+            return buf.size() > HTTP_MAX_HEADER ? -1 : 0;
+        }
 
-    switch (choice) {
-        case 1: {
-            int id;
-            cout << "ҩƷID";
-            cin >> id;
-            cin.ignore(); // 
-            Medicine *med = findMedicine(list, id);
-            if (med != nullptr) {
-                cout << "\nѯ" << endl;
-                cout << "ID" << med->id << endl;
-                cout << "ƣ" << med->name << endl;
-                cout << "أ" << med->origin << endl;
-                cout << "" << med->spec << endl;
-                cout << "" << med->stock << "g" << endl;
-                cout << "Ԥֵ" << med->warning_threshold << "g" << endl;
-                cout << "Ԥ״̬" << (med->is_warning ? "Ԥ" : "") << endl;
-            } else {
-                cout << "ѯδҵID=" << id << "ҩƷ" << endl;
+        size_t line_end = buf.find("\r\n");
+        string line = buf.substr(0, line_end);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = line.rfind(' ');
+        error_status = 400;
+        if (sp1 == string::npos || sp2 == sp1) return -1;
+        req.method = line.substr(0, sp1);
+        string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        string version = line.substr(sp2 + 1);
+        req.keep_alive = version == "HTTP/1.1";
+
+        size_t content_length = 0;
+        bool form = false;
+        req.host.clear();
+        req.origin.clear();
+        req.requested_with = false;
+        size_t pos = line_end + 2;
+        while (pos < header_end) {
+            size_t eol = buf.find("\r\n", pos);
+            string header = buf.substr(pos, eol - pos);
+            pos = eol + 2;
+            size_t colon = header.find(':');
+            if (colon == string::npos) continue;
+            string name = header.substr(0, colon);
+            string value = header.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+            transform(value.begin(), value.end(), value.begin(), ::tolower);
+            if (name == "content-length") {
+                content_length = strtoul(value.c_str(), nullptr, 10);
+            } else if (name == "connection") {
+                if (value == "close") req.keep_alive = false;
+                if (value == "keep-alive") req.keep_alive = true;
+            } else if (name == "content-type") {
+                form = value.compare(0, 33, "application/x-www-form-urlencoded") == 0;
+            } else if (name == "host") {
+                req.host = value;
+            } else if (name == "origin") {
+                req.origin = value;
+            } else if (name == "x-requested-with") {
+                req.requested_with = true;
             }
-            break;
         }
+        if (content_length > HTTP_MAX_BODY) {
+            error_status = 413;
+            return -1;
+        }
+        size_t total = header_end + 4 + content_length;
+        if (buf.size() < total) return 0;
 
-        case 2: {
-            char keyword[MAX_NAME_LEN];
-            cout << "ҩƷƹؼ֣";
-            safeReadString(keyword, MAX_NAME_LEN);
+        size_t query = target.find('?');
+        req.path = target.substr(0, query);
+        req.params.clear();
+        if (query != string::npos) parseUrlParams(target.substr(query + 1), req.params);
+        if (form) parseUrlParams(buf.substr(header_end + 4, content_length), req.params);
+        return (long)total;
+    }
 
-            cout << "\nѯư\"" << keyword << "\"ҩƷ" << endl;
-            cout << "ID\t\t\t\t\t\t\t\tԤ״̬" << endl;
-            cout << "------------------------------------------------------------" << endl;
+    void queueResponse(HttpConnection& conn, const HttpResponse& res, bool keep_alive) {
+        char head[256];
+        sprintf(head, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\n"
+                      "Cache-Control: no-store\r\nConnection: %s\r\n\r\n",
+                res.status, httpStatusText(res.status), res.content_type, (unsigned long)res.body.size(),
+                keep_alive ? "keep-alive" : "close");
+        conn.out += head;
+        conn.out += res.body;
+        if (!keep_alive) conn.close_after = true;
+    }
 
-            int count = 0;
-            for (int i = 0; i < list->length; i++) {
-                Medicine med = list->medicines[i];
-                if (strstr(med.name, keyword) != nullptr) {
-                    printf("%d\t%s\t\t%s\t\t%s\t\t%d\t%s\n",
-                           med.id, med.name, med.origin, med.spec,
-                           med.stock, med.is_warning ? "Ԥ" : "");
-                    count++;
-                }
+    void closeConnection(socket_t fd) {
+        poller.remove(fd);
+        closeSocket(fd);
+        connections.erase(fd);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            socket_t fd = accept(listener, nullptr, nullptr);
+            if (fd == BAD_SOCKET) return;
+            if (connections.size() >= HTTP_MAX_CONNECTIONS || !setNonBlocking(fd)) {
+                closeSocket(fd);
+                continue;
             }
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+            connections[fd] = HttpConnection();
+            poller.add(fd);
+        }
+    }
 
-            if (count == 0) {
-                cout << "ƥ" << endl;
-            } else {
-                cout << "ҵ" << count << "ƥҩƷ" << endl;
+    // ʹݣfalseʾѹر
+    bool flushConnection(socket_t fd, HttpConnection& conn) {
+        if (conn.held) return true;
+        while (conn.out_pos < conn.out.size()) {
+            int n = send(fd, conn.out.data() + conn.out_pos, (int)(conn.out.size() - conn.out_pos), 0);
+            if (n < 0 && socketWouldBlock()) break;
+            if (n <= 0) {
+                closeConnection(fd);
+                return false;
+            }
+            conn.out_pos += n;
+        }
+        if (conn.out_pos == conn.out.size()) {
+            conn.out.clear();
+            conn.out_pos = 0;
+            if (conn.close_after) {
+                closeConnection(fd);
+                return false;
             }
-            break;
         }
+        poller.setWantWrite(fd, !conn.out.empty());
+        return true;
+    }
 
-        default:
-            cout << "Чѯʽ" << endl;
-            break;
+    void readConnection(socket_t fd, HttpConnection& conn) {
+        char buf[16384];
+        while (true) {
+            int n = recv(fd, buf, sizeof(buf), 0);
+            if (n < 0 && socketWouldBlock()) break;
+            if (n <= 0) {
+                closeConnection(fd);
+                return;
+            }
+            conn.in.append(buf, n);
+        }
+
+        // Ͽһεδ
+        while (!conn.close_after) {
+            HttpRequest req;
+            int error_status = 400;
+            long used = parseRequest(conn.in, req, error_status);
+            if (used == 0) break;
+            HttpResponse res;
+            res.content_type = "application/json; charset=utf-8";
+            if (used < 0) {
+                jsonError(res, error_status, "bad_request");
+                queueResponse(conn, res, false);
+                break;
+            }
+            conn.in.erase(0, used);
+            route(req, res);
+            queueResponse(conn, res, req.keep_alive);
+        }
+        // ޸ĿˮǰӦ𣬷ǰᶪʧѸ֪ɹĳ⣨ύͳһͣ
+        if (changed && !conn.held && !conn.out.empty()) {
+            conn.held = true;
+            held.push_back(fd);
+        }
+        flushConnection(fd, conn);
     }
-}
 
-void showAllMedicines(OrderedList *list) {
-    if (list == nullptr || list->length == 0) {
-        cout << "Ϊգ" << endl;
-        return;
+public:
+    HttpServer(OrderedList *inv, CircularQueue *queue, LinkedStack *stack, Journal *j)
+        : inventory(inv), inQueue(queue), outStack(stack), journal(j),
+          stats(inv, queue, stack), listener(BAD_SOCKET), changed(false), port(0) {}
+
+    ~HttpServer() {
+        for (auto& c : connections) closeSocket(c.first);
+        if (listener != BAD_SOCKET) closeSocket(listener);
     }
 
-    cout << "\n===== ҩƷϢID =====" << endl;
-    cout << "ID\t\t\t\t\t\t\tg\tԤֵg\tԤ״̬" << endl;
-    cout << "------------------------------------------------------------------------" << endl;
+    // 127.0.0.1:portϼ0ɹ
+    int start(int listen_port) {
+        port = listen_port;
+        ifstream file(HTTP_PAGE_FILE, ios::binary);
+        if (file) page.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
 
-    for (int i = 0; i < list->length; i++) {
-        Medicine med = list->medicines[i];
-        printf("%d\t%s\t\t%s\t\t%s\t\t%d\t\t%d\t\t%s\n",
-               med.id, med.name, med.origin, med.spec,
-               med.stock, med.warning_threshold,
-               med.is_warning ? "Ԥ" : "");
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == BAD_SOCKET) return -1;
+        int on = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((unsigned short)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0 ||
+            !setNonBlocking(listener) || !poller.open()) {
+            return -1;
+        }
+        poller.add(listener);
+        return 0;
     }
 
-    cout << "\nϼƣ" << list->length << "ҩƷ" << endl;
-}
+    // ¼ѭյֹͣźź󷵻أÿ¼ͳһˮٷ͵ȴ̵Ӧ
+    void run() {
+        vector<PollEvent> events;
+        while (!g_http_stop) {
+            poller.wait(events, 200);
+            refreshCurrentDay();
+            outStack->sealExpired(g_current_day);
+            for (size_t i = 0; i < events.size(); i++) {
+                socket_t fd = events[i].fd;
+                if (fd == listener) {
+                    acceptConnections();
+                    continue;
+                }
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                if (events[i].writable && !flushConnection(fd, it->second)) continue;
+                if (events[i].readable) readConnection(fd, it->second);
+            }
+            if (changed) {
+                commitJournal(journal);
+                changed = false;
+            }
+            for (size_t i = 0; i < held.size(); i++) {
+                auto it = connections.find(held[i]);
+                if (it == connections.end()) continue;
+                it->second.held = false;
+                flushConnection(held[i], it->second);
+            }
+            held.clear();
+        }
+    }
+};
 
-void medicineManagementMenu(OrderedList *list) {
-    int choice;
-    while (true) {
-        system("cls");
-        cout << "==================== ҩƷģ ====================" << endl;
-        cout << "1. ҩƷ" << endl;
-        cout << "2. ޸ҩƷϢ" << endl;
-        cout << "3. ɾҩƷ" << endl;
-        cout << "4. ѯҩƷ" << endl;
-        cout << "5. ʾҩƷ" << endl;
-        cout << "0. ˵" << endl;
-        cout << "======================================================" << endl;
-        cout << "ѡ0-5";
-        cin >> choice;
-        cin.ignore(); // 
+// ģʽ̣Ctrl+Cֹֹͣͣʱˮ
+int runHttpServer(int port, OrderedList *inventory, CircularQueue *inQueue, LinkedStack *outStack,
+                  Journal *journal) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return -1;
+#else
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    signal(SIGINT, onHttpStopSignal);
+    signal(SIGTERM, onHttpStopSignal);
 
-        switch (choice) {
-            case 1: addMedicine(list); break;
-            case 2: modifyMedicine(list); break;
-            case 3: removeMedicine(list); break;
-            case 4: queryMedicine(list); break;
-            case 5: showAllMedicines(list); break;
-            case 0: cout << "˵" << endl; return;
-            default: cout << "Чѡ" << endl; break;
+    int result = 0;
+    {
+        HttpServer server(inventory, inQueue, outStack, journal);
+        if (server.start(port) != 0) {
+            cout << "޷ 127.0.0.1:" << port << endl;
+            result = -1;
+        } else {
+            cout << "ӿڷhttp://127.0.0.1:" << port << "/ Ctrl+C ֹͣ" << endl;
+            logEvent(LOG_INFO, "http", "listening on 127.0.0.1:%d", port);
+            server.run();
         }
+    }
 
-        cout << "\n..." << endl;
-        _getch();
+    autoCheckWarnings(inventory);
+    if (checkpointCatalogue(inventory, journal, outStack) != 0) {
+        cout << "棺ʧܣ" << endl;
+        logEvent(LOG_ERROR, "storage", "save %s failed", CATALOGUE_FILE);
     }
+    logEvent(LOG_INFO, "http", "stopped");
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return result;
 }
 
 // ˵
-void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack *outStack) {
+void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack *outStack,
+                    Journal *journal) {
     Statistics stats(inventory, inQueue, outStack);
     
     int choice;
     while (true) {
+        refreshCurrentDay(); // ʱ֮
+        outStack->sealExpired(g_current_day);
+        
         system("cls");
         cout << "==================== ҩԤϵͳ ====================" << endl;
         cout << "1. ҩƷģ" << endl;
@@ -1132,14 +6743,18 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
         cout << "5. " << endl;
         cout << "6. " << endl;
         cout << "7. ⵥ" << endl;
+        cout << "8. " << endl;
+        cout << "9. ݱָ" << endl;
+        cout << "10. ܲ" << endl;
+        cout << "11. ϵͳָ" << endl;
         cout << "0. ˳ϵͳ" << endl;
         cout << "========================================================" << endl;
-        cout << "ѡ0-7";
+        cout << "ѡ0-11";
         cin >> choice;
         cin.ignore(); // 
         
         switch (choice) {
-            case 1: medicineManagementMenu(inventory); break;
+            case 1: medicineManagementMenu(inventory, journal, outStack); break;
             
             case 2: {
                 system("cls");
@@ -1148,6 +6763,7 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                 cout << "2. Ԥֵ" << endl;
                 cout << "3. ʾԤҩƷ" << endl;
                 cout << "4. Ԥ" << endl;
+                cout << "5. ȫԤֵ" << endl;
                 cout << "0. ˵" << endl;
                 cout << "======================================================" << endl;
                 
@@ -1193,11 +6809,15 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                         cin.ignore(); // 
                         Medicine *med = findMedicine(inventory, id);
                         if (med != nullptr) {
-                            setWarningThreshold(med);
+                            {
+                                StructureWriteGuard guard(inventory->lock);
+                                setWarningThreshold(med);
+                                syncMedicineColumns(inventory, med);
+                            }
                             cout << "ԤֵѸ£ֵ" << med->warning_threshold << "g" << endl;
                             
                             // ¼Ԥ״̬
-                            checkAndHandleWarnings(inventory, id);
+                            markWarningDirty(inventory->warnings, id);
                         } else {
                             cout << "δҵҩƷ" << endl;
                         }
@@ -1205,17 +6825,14 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                     }
                     case 3: {
                         cout << "\n======= ǰԤҩƷ =======\n";
-                        bool found_warning = false;
-                        for (int i = 0; i < inventory->length; i++) {
-                            if (inventory->medicines[i].is_warning) {
-                                cout << "ID: " << inventory->medicines[i].id 
-                                     << ", : " << inventory->medicines[i].name
-                                     << ", : " << inventory->medicines[i].stock << "g"
-                                     << ", ֵ: " << inventory->medicines[i].warning_threshold << "g" << endl;
-                                found_warning = true;
-                            }
+                        vector<Medicine*> warning_list = getWarningMedicines(inventory);
+                        for (size_t i = 0; i < warning_list.size(); i++) {
+                            cout << "ID: " << warning_list[i]->id 
+                                 << ", : " << warning_list[i]->name
+                                 << ", : " << warning_list[i]->stock << "g"
+                                 << ", ֵ: " << warning_list[i]->warning_threshold << "g" << endl;
                         }
-                        if (!found_warning) {
+                        if (warning_list.empty()) {
                             cout << "ǰԤҩƷ" << endl;
                         }
                         break;
@@ -1223,6 +6840,12 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                     case 4: 
                         updateAllWarnings(inventory);
                         break;
+                    case 5: {
+                        int changed = refreshAllThresholds(inventory);
+                        cout << "" << inventory->length << "ҩƷԤֵ"
+                             << changed << "б仯" << warningKernels().name << "ںˣ" << endl;
+                        break;
+                    }
                     case 0: break;
                     default: cout << "Ч" << endl;
                 }
@@ -1291,7 +6914,7 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                     case 5: {
                         double avgTime = stats.getAvgResponseTime(dateStr);
                         cout << "\n======= ԤӦʱͳ =======\n";
-                        cout << "ƽӦʱ: " << fixed << setprecision(2) << avgTime << " Сʱ" << endl;
+                        cout << dateStr << " ԤƽӦʱ: " << fixed << setprecision(2) << avgTime << " Сʱ" << endl;
                         break;
                     }
                     case 0: break;
@@ -1315,30 +6938,26 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                 cout << "Ա";
                 safeReadString(operatorName, 20);
                 
-                // ҩƷ
-                Medicine *med = findMedicine(inventory, medId);
-                if (med == nullptr) {
+                bool queued = false;
+                int result = receiveMedicine(inventory, inQueue, journal, medId, quantity,
+                                             operatorName, &queued, 0);
+                if (result == -1) {
                     cout << "ҩƷID " << medId << " ڣ" << endl;
                     break;
                 }
-                
-                // ӿ
-                med->stock += quantity;
+                if (result == -2) {
+                    cout << "дˮ־ʧܣȡ" << endl;
+                    break;
+                }
+                if (result == -3) {
+                    cout << "潫ޣȡ" << endl;
+                    break;
+                }
                 cout << "ɹҩƷID " << medId << " " << quantity 
-                     << "ǰ " << med->stock << endl;
-                
-                // ʵʱԤ״̬
-                checkAndHandleWarnings(inventory, medId);
-                
-                // ⵥУڼ¼ͺ
-                InOrder order;
-                order.med_id = medId;
-                order.quantity = quantity;
-                strcpy(order.operator_name, operatorName);
-                order.in_time = time(nullptr);
-                strftime(order.date, sizeof(order.date), "%Y-%m-%d", localtime(&order.in_time));
+                     << "ǰ " << findMedicine(inventory, medId)->stock << endl;
                 
-                if (enqueue(inQueue, order)) {
+                // ⵥӵУڼ¼ͺ
+                if (queued) {
                     cout << "ⵥӵУ" << endl;
                 } else {
                     cout << "棺ⵥ" << endl;
@@ -1361,38 +6980,22 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                 cout << "봦ţ";
                 safeReadString(prescriptionNo, 30);
                 
-                time_t now = time(nullptr);
-                char dateStr[11];
-                strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", localtime(&now));
-                
-                // ȼٿ
-                Medicine* med = findMedicine(inventory, medId);
-                if (med == nullptr) {
+                int result = dispenseMedicine(inventory, outStack, journal, medId, quantity,
+                                              prescriptionNo, 0);
+                if (result == -1) {
                     cout << "ҩƷID " << medId << " ڣ" << endl;
                     break;
                 }
-                
-                if (med->stock < quantity) {
-                    cout << "󣺿治㣡ǰ " << med->stock << " " << quantity << endl;
+                if (result == -2) {
+                    cout << "󣺿治㣡ǰ " << findMedicine(inventory, medId)->stock
+                         << " " << quantity << endl;
                     break;
                 }
-                
-                med->stock -= quantity;
-                
-                // ӳⵥ
-                outStack->push(medId, quantity, prescriptionNo, dateStr);
-                cout << "ɹǰ棺" << med->stock << endl;
-                
-                // ʷ
-                if (med->usage_history[6] == 0) { // ǵһγ
-                    med->usage_history[6] = quantity;
-                    med->last_usage = quantity;
-                } else {
-                    med->usage_history[6] += quantity;
+                if (result == -3) {
+                    cout << "дˮ־ʧܣȡ" << endl;
+                    break;
                 }
-                
-                // ʵʱԤ״̬
-                checkAndHandleWarnings(inventory, medId);
+                cout << "ɹǰ棺" << findMedicine(inventory, medId)->stock << endl;
                 break;
             }
             
@@ -1405,7 +7008,66 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
                 break;
             }
             
+            case 8: {
+                if (checkpointCatalogue(inventory, journal, outStack) == 0) {
+                    cout << "ѱ浽 " << CATALOGUE_FILE << "" << inventory->length << "ҩƷ" << endl;
+                } else {
+                    cout << "󣺱ʧܣ" << endl;
+                }
+                break;
+            }
+            
+            case 9: {
+                system("cls");
+                cout << "==================== ݱָ ====================" << endl;
+                cout << "1. " << endl;
+                cout << "2. ӱݻָ" << endl;
+                cout << "0. ˵" << endl;
+                cout << "========================================================" << endl;
+                
+                int subChoice;
+                cout << "ѡ";
+                cin >> subChoice;
+                cin.ignore(); // 
+                
+                if (subChoice != 1 && subChoice != 2) break;
+                
+                char backupName[100];
+                cout << "뱸ƣ";
+                safeReadString(backupName, 100);
+                
+                if (subChoice == 1) {
+                    if (backupData(inventory, journal, backupName) == 0) {
+                        cout << "ݳɹ" << endl;
+                    } else {
+                        cout << "󣺱ʧܣ" << endl;
+                    }
+                } else {
+                    if (restoreData(inventory, inQueue, outStack, journal, backupName) == 0) {
+                        cout << "ָɹǰ" << inventory->length << "ҩƷ" << endl;
+                    } else {
+                        cout << "󣺻ָʧܣ鱸ļ" << endl;
+                    }
+                }
+                break;
+            }
+            
+            case 10:
+                benchmarkMenu();
+                break;
+            
+            case 11:
+                metricsMenu();
+                break;
+            
             case 0: 
+                if (checkpointCatalogue(inventory, journal, outStack) != 0) {
+                    cout << "棺ʧܣ" << endl;
+                    logEvent(LOG_ERROR, "storage", "save %s failed", CATALOGUE_FILE);
+                }
+                closeJournal(journal);
+                logEvent(LOG_INFO, "system", "shutdown");
+                stopSystemLog();
                 destroyOrderedList(inventory);
                 destroyQueue(inQueue);
                 delete outStack;
@@ -1414,14 +7076,64 @@ void systemMainMenu(OrderedList *inventory, CircularQueue *inQueue, LinkedStack
             default: cout << "Ч" << endl;
         }
         
+        // Ԥֻβпֵ䶯ҩƷʾһ
+        autoCheckWarnings(inventory);
+        WarningEngine *engine = inventory->warnings;
+        if (engine->raised > 0 || engine->cleared > 0) {
+            cout << "\nԤԤ " << engine->raised << " ֣ "
+                 << engine->cleared << " ֣ 2-3 ʾԤҩƷ" << endl;
+            engine->raised = engine->cleared = 0;
+        }
+        
+        // ύβˮͳһ
+        commitJournal(journal);
+        
         cout << "\n˵...";
         _getch();
     }
 }
 
-int main() {
-    // ϵͳ
-    OrderedList *inventory = createOrderedList(MAX_MEDICINES);
+// ÷test02               ˵
+//       test02 --batch [ļ]  ģʽʡļΪ"-"ʱ׼
+//       test02 --serve [˿]  HTTP/JSONӿڣĬ8080 http://127.0.0.1:˿/
+int main(int argc, char *argv[]) {
+    bool batch = argc >= 2 && strcmp(argv[1], "--batch") == 0;
+    bool serve = argc >= 2 && strcmp(argv[1], "--serve") == 0;
+    
+    // ׼ʹúϳݣؿ桢д־
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        const char *output = BENCH_RESULT_FILE;
+        bool full = false;
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--full") == 0) full = true;
+            else output = argv[i];
+        }
+        return runBenchSuite(output, full) == 0 ? 0 : 1;
+    }
+    // ϳطţ--workload [] [] [ƽմ] [ҩƷ]
+    if (argc >= 2 && strcmp(argv[1], "--workload") == 0) {
+        WorkloadConfig config = {1, 30, 400, 1000};
+        if (argc >= 3) config.seed = (unsigned int)strtoul(argv[2], nullptr, 10);
+        if (argc >= 4) config.days = max(1, min(USAGE_WINDOW_DAYS, atoi(argv[3])));
+        if (argc >= 5) config.prescriptions_per_day = max(1, atoi(argv[4]));
+        if (argc >= 6) config.medicines = max(20, atoi(argv[5]));
+        return runWorkload(config) == 0 ? 0 : 1;
+    }
+    
+    // ϵͳȴϴαĿļأļȴ޷ʱܾ
+    // ˳ʱĿտḲԭļ
+    LoadStatus load_status;
+    OrderedList *inventory = loadFromFile(CATALOGUE_FILE, &load_status);
+    if (inventory == nullptr) {
+        if (load_status != LOAD_MISSING) {
+            const char *reason = load_status == LOAD_CORRUPT ? "ļ" :
+                                 load_status == LOAD_UNSUPPORTED ? "汾" : "޷ȡ";
+            cout << "󣺿ļ " << CATALOGUE_FILE << " " << reason << "ϵͳδԭļֲ䡣" << endl;
+            cout << "ӱݻָļߺӿտ濪ʼ" << endl;
+            return 1;
+        }
+        inventory = createOrderedList(MAX_MEDICINES);
+    }
     CircularQueue *inQueue = createQueue(100);
     LinkedStack *outStack = new LinkedStack();
     
@@ -1430,8 +7142,43 @@ int main() {
         return -1;
     }
     
+    if (!startSystemLog(LOG_FILE, LOG_INFO)) {
+        cout << "棺޷ϵͳ־ " << LOG_FILE << endl;
+    }
+    logEvent(LOG_INFO, "system", "startup medicines=%d", inventory->length);
+    
+    // ڿջطˮ־ѹ鵵ڵĳⵥڴ棩Ȼ׷
+    refreshCurrentDay();
+    if (outStack->openArchive(HISTORY_MANIFEST, HISTORY_HOT_DAYS) != 0) {
+        cout << "棺ֳʷ鵵޷ȡ " << LOG_FILE << endl;
+    }
+    unsigned int last_seq = replayJournal(JOURNAL_FILE, inventory, inQueue, outStack);
+    outStack->sealExpired(g_current_day);
+    Journal *journal = openJournal(JOURNAL_FILE, last_seq + 1, JOURNAL_BATCH_SIZE);
+    if (journal == nullptr) {
+        cout << "󣺴ˮ־ʧܣ" << endl;
+        return -1;
+    }
+    
+    // ʱԤѼ־ټһβĻ
+    inventory->warnings->raised = inventory->warnings->cleared = 0;
+    
+    if (batch) {
+        int failed = runBatchMode(argc >= 3 ? argv[2] : nullptr, inventory, inQueue, outStack, journal);
+        closeJournal(journal);
+        stopSystemLog();
+        return failed == 0 ? 0 : 2;
+    }
+    if (serve) {
+        int port = argc >= 3 ? atoi(argv[2]) : HTTP_DEFAULT_PORT;
+        int result = runHttpServer(port, inventory, inQueue, outStack, journal);
+        closeJournal(journal);
+        stopSystemLog();
+        return result == 0 ? 0 : 1;
+    }
+    
     // ϵͳ˵
-    systemMainMenu(inventory, inQueue, outStack);
+    systemMainMenu(inventory, inQueue, outStack, journal);
     
     return 0;
 }
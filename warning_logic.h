@@ -4,19 +4,33 @@
 
 #include "ordered_list.h"
 
+// daysվֻͳӣO(1)
+int calculateAverageUsage(Medicine *med, int days);
+
 // ǰվĿҪ
 int calculateThreeDayAverage(Medicine *med);
 
 // Ԥֵǰվֵ10%һ
 void setWarningThreshold(Medicine *med);
 
-// 鲢ҩƷԤ״̬
+// ȫҩƷԤֵб仯ҩƷ
+int refreshAllThresholds(OrderedList *inventory);
+
+// ںˣAVX2ʱCPU֧ʱñ汾
+int collectWarningFlipsScalar(const int *stock, const int *threshold,
+                              const unsigned char *warning, int n, int *slots);
+void computeThresholdsScalar(const int *avg, const int *last_usage, int n, int *threshold);
+
+// 鵥ҩƷԤ״̬÷ѳҩƷָ룩
+void checkMedicineWarning(OrderedList *inventory, Medicine *med);
+
+// 鲢ҩƷԤ״̬ȫ㣩
 void updateAllWarnings(OrderedList *inventory);
 
 // ȡԤӦʱ䣨Ԥʼʱ
 double getWarningResponseTime(Medicine *med);
 
-// ԶԤ飨Ϊʱ
-void autoCheckWarnings(OrderedList *inventory);
+// Ԥ飺ֵֻ䶯ҩƷ
+int autoCheckWarnings(OrderedList *inventory);
 
 #endif